@@ -0,0 +1,5 @@
+#include "FixedVector.h"
+
+VECTOR_DEFINE(Vec3, 3)
+VECTOR_DEFINE(Vec16, 16)
+VECTOR_DEFINE(Vec128, 128)
@@ -0,0 +1,132 @@
+#ifndef TA_EX3_FIXEDVECTOR_H
+#define TA_EX3_FIXEDVECTOR_H
+
+#include "Structs.h"
+#include <stdlib.h>
+
+/**
+ * generators of vector types of a fixed dimension, known at compile time. the coefficients are
+ * stored inline, so a vector is a single allocation, and every loop has a constant trip count the
+ * compiler can unroll and vectorize.
+ * VECTOR_DECLARE(Name, N) declares the type Name and its functions (in a header), and
+ * VECTOR_DEFINE(Name, N) defines the functions (in a single .c file):
+ * 	Name - the type, with N coefficients in vector, and a cached norm as in Vector.
+ * 	Name *Name##FromVector(const Vector *v) - a new Name in the heap with the coefficients of v,
+ * 		NULL on failure or if v->len != N.
+ * 	int Name##Compare1By1(const void *a, const void *b) - CompFunc, same order as vectorCompare1By1.
+ * 	double Name##SquaredNorm(Name *v) - the squared norm, computed on the first call and cached.
+ * 	void Name##Empty(Name *v) - sets up v as an empty destination for Name##CopyIfNormIsLarger.
+ * 	int Name##CopyIfNormIsLarger(const void *pVector, void *pMaxVector) - copyIfNormIsLarger,
+ * 		pMaxVector is either a Name or an empty destination set up with Name##Empty.
+ * 	void Name##Free(void *pVector) - FreeFunc.
+ */
+#define VECTOR_DECLARE(Name, N) \
+	typedef struct Name \
+	{ \
+		double vector[N]; \
+		int flags; /* VECTOR_* flags. */ \
+		double sqrNorm; /* cached squared norm, valid iff flags & VECTOR_NORM_CACHED. */ \
+	} Name; \
+	Name *Name##FromVector(const Vector *v); \
+	int Name##Compare1By1(const void *a, const void *b); \
+	double Name##SquaredNorm(Name *v); \
+	void Name##Empty(Name *v); \
+	int Name##CopyIfNormIsLarger(const void *pVector, void *pMaxVector); \
+	void Name##Free(void *pVector);
+
+#define VECTOR_DEFINE(Name, N) \
+	Name *Name##FromVector(const Vector *v) \
+	{ \
+		if (v == NULL || v->len != (N)) \
+		{ \
+			return NULL; \
+		} \
+		Name *fixed = (Name *) malloc(sizeof(Name)); \
+		if (fixed == NULL) \
+		{ \
+			return NULL; \
+		} \
+		for (int i = 0; i < (N); i++) \
+		{ \
+			fixed->vector[i] = v->vector[i]; \
+		} \
+		fixed->flags = 0; \
+		fixed->sqrNorm = 0; \
+		return fixed; \
+	} \
+	\
+	int Name##Compare1By1(const void *a, const void *b) \
+	{ \
+		const double *x = ((const Name *) a)->vector; \
+		const double *y = ((const Name *) b)->vector; \
+		for (int i = 0; i < (N); i++) \
+		{ \
+			if (x[i] > y[i]) \
+			{ \
+				return 1; \
+			} \
+			else if (x[i] < y[i]) \
+			{ \
+				return -1; \
+			} \
+		} \
+		return 0; \
+	} \
+	\
+	double Name##SquaredNorm(Name *v) \
+	{ \
+		if (!(v->flags & VECTOR_NORM_CACHED)) \
+		{ \
+			/* four independent sums, as in sumOfSquares. */ \
+			double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0; \
+			int i = 0; \
+			for (; i + 4 <= (N); i += 4) \
+			{ \
+				sum0 += v->vector[i] * v->vector[i]; \
+				sum1 += v->vector[i + 1] * v->vector[i + 1]; \
+				sum2 += v->vector[i + 2] * v->vector[i + 2]; \
+				sum3 += v->vector[i + 3] * v->vector[i + 3]; \
+			} \
+			for (; i < (N); i++) \
+			{ \
+				sum0 += v->vector[i] * v->vector[i]; \
+			} \
+			v->sqrNorm = (sum0 + sum1) + (sum2 + sum3); \
+			v->flags |= VECTOR_NORM_CACHED; \
+		} \
+		return v->sqrNorm; \
+	} \
+	\
+	void Name##Empty(Name *v) \
+	{ \
+		v->flags = VECTOR_EMPTY; \
+		v->sqrNorm = 0; \
+	} \
+	\
+	int Name##CopyIfNormIsLarger(const void *pVector, void *pMaxVector) \
+	{ \
+		if (pVector == NULL || pMaxVector == NULL) \
+		{ \
+			return 0; \
+		} \
+		Name *src = (Name *) pVector; \
+		Name *dest = (Name *) pMaxVector; \
+		double srcNorm = Name##SquaredNorm(src); /* cached before the copy, so dest gets it. */ \
+		if ((dest->flags & VECTOR_EMPTY) || srcNorm > Name##SquaredNorm(dest)) \
+		{ \
+			*dest = *src; \
+		} \
+		return 1; \
+	} \
+	\
+	void Name##Free(void *pVector) \
+	{ \
+		free(pVector); \
+	}
+
+// the dimensions in common use.
+VECTOR_DECLARE(Vec3, 3)
+VECTOR_DECLARE(Vec16, 16)
+VECTOR_DECLARE(Vec128, 128)
+
+#endif //TA_EX3_FIXEDVECTOR_H
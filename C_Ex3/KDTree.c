@@ -0,0 +1,356 @@
+#include "KDTree.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define KD_BOUND_STRIDE 8 // coefficients summed between checks of the bound.
+#define KD_SCAN_DIM 10 // from that dimension on pruning rarely skips a subtree, a plain scan is faster.
+
+/**
+ * the k closest points found so far, kept in a max heap by their distance from the query.
+ */
+typedef struct KDSearch
+{
+    const KDTree *index;
+    const double *query;
+    const Vector **points;
+    double *sqrDistances;
+    int size;
+    int capacity;
+} KDSearch;
+
+/**
+ * rearranges points[low, high) so that points[nth] is the one that would be there if the range
+ * was sorted along axis, with no larger point before it and no smaller point after it.
+ * @param points - array of vectors.
+ * @param low - first index of the range.
+ * @param high - index after the range.
+ * @param nth - the index to fill.
+ * @param axis - the coefficient to compare by.
+ */
+void selectKDMedian(const Vector **points, int low, int high, int nth, int axis)
+{
+    while (high - low > 1)
+    {
+        // the median of three as a pivot avoids the worst case for sorted input.
+        double a = points[low]->vector[axis];
+        double b = points[low + (high - low) / 2]->vector[axis];
+        double c = points[high - 1]->vector[axis];
+        double pivot = (a < b) ? ((b < c) ? b : (a < c) ? c : a) : ((a < c) ? a : (b < c) ? c : b);
+        int i = low, j = high - 1;
+        while (i <= j)
+        {
+            while (points[i]->vector[axis] < pivot)
+            {
+                i++;
+            }
+            while (points[j]->vector[axis] > pivot)
+            {
+                j--;
+            }
+            if (i <= j)
+            {
+                const Vector *temp = points[i];
+                points[i++] = points[j];
+                points[j--] = temp;
+            }
+        }
+        // points[low, j] <= pivot <= points[i, high), and the points between them equal pivot.
+        if (nth <= j)
+        {
+            high = j + 1;
+        }
+        else if (nth >= i)
+        {
+            low = i;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @return the axis in which points[low, high) are spread the most.
+ */
+int getWidestKDAxis(const Vector **points, int low, int high, int dim)
+{
+    int widest = 0;
+    double widestSpread = -1;
+    for (int axis = 0; axis < dim; axis++)
+    {
+        double min = points[low]->vector[axis], max = min;
+        for (int i = low + 1; i < high; i++)
+        {
+            double value = points[i]->vector[axis];
+            min = (value < min) ? value : min;
+            max = (value > max) ? value : max;
+        }
+        if (max - min > widestSpread)
+        {
+            widestSpread = max - min;
+            widest = axis;
+        }
+    }
+    return widest;
+}
+
+/**
+ * builds the subtree of points[low, high).
+ */
+void buildKDTree(KDTree *index, int low, int high)
+{
+    if (high - low <= 0)
+    {
+        return;
+    }
+    int middle = low + (high - low) / 2;
+    int axis = (index->dim > 0) ? getWidestKDAxis(index->points, low, high, index->dim) : 0;
+    if (index->dim > 0)
+    {
+        selectKDMedian(index->points, low, high, middle, axis);
+    }
+    index->axes[middle] = axis;
+    buildKDTree(index, low, middle);
+    buildKDTree(index, middle + 1, high);
+}
+
+KDTree *newKDTree(Vector *const *vectors, int n)
+{
+    if (vectors == NULL || n < 0)
+    {
+        return NULL;
+    }
+    for (int i = 1; i < n; i++)
+    {
+        if (vectors[i]->len != vectors[0]->len)
+        {
+            return NULL;
+        }
+    }
+    KDTree *index = (KDTree *) malloc(sizeof(KDTree));
+    if (index == NULL)
+    {
+        return NULL;
+    }
+    index->points = (const Vector **) malloc((n > 0 ? n : 1) * sizeof(Vector *));
+    index->axes = (int *) malloc((n > 0 ? n : 1) * sizeof(int));
+    if (index->points == NULL || index->axes == NULL)
+    {
+        freeKDTree(index);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        index->points[i] = vectors[i];
+    }
+    index->size = n;
+    index->dim = (n > 0) ? vectors[0]->len : 0;
+    if (index->dim < KD_SCAN_DIM)
+    {
+        buildKDTree(index, 0, n);
+    }
+    return index;
+}
+
+KDTree *newKDTreeFromRBTree(RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    Vector **vectors = flattenVectors(tree, forEachVectorTree, tree->size);
+    if (vectors == NULL)
+    {
+        return NULL;
+    }
+    KDTree *index = newKDTree(vectors, tree->size);
+    free(vectors);
+    return index;
+}
+
+/**
+ * @return the squared distance between point and the query, or a value >= bound as soon as the
+ * partial sum reaches bound (the point can't be one of the k closest then). the bound is checked
+ * once every KD_BOUND_STRIDE coefficients, a check per coefficient is a mispredicted branch.
+ */
+double getKDSquaredDistance(const double *point, const double *query, int dim, double bound)
+{
+    double sum = 0;
+    int i = 0;
+    for (; i + KD_BOUND_STRIDE <= dim; i += KD_BOUND_STRIDE)
+    {
+        for (int j = i; j < i + KD_BOUND_STRIDE; j++)
+        {
+            double diff = point[j] - query[j];
+            sum += diff * diff;
+        }
+        if (sum >= bound)
+        {
+            return sum;
+        }
+    }
+    for (; i < dim; i++)
+    {
+        double diff = point[i] - query[i];
+        sum += diff * diff;
+    }
+    return sum;
+}
+
+/**
+ * replaces the farthest of the points in the heap, and moves the new point down to its place.
+ */
+void replaceKDFarthest(KDSearch *search, const Vector *point, double sqrDistance)
+{
+    int index = 0;
+    while (2 * index + 1 < search->size)
+    {
+        int child = 2 * index + 1;
+        if (child + 1 < search->size && search->sqrDistances[child + 1] > search->sqrDistances[child])
+        {
+            child++;
+        }
+        if (search->sqrDistances[child] <= sqrDistance)
+        {
+            break;
+        }
+        search->points[index] = search->points[child];
+        search->sqrDistances[index] = search->sqrDistances[child];
+        index = child;
+    }
+    search->points[index] = point;
+    search->sqrDistances[index] = sqrDistance;
+}
+
+/**
+ * offers a point to the heap of the k closest points, it is kept if it is closer than the
+ * farthest of them.
+ */
+void offerKDNeighbour(KDSearch *search, const Vector *point, double sqrDistance)
+{
+    if (search->size == search->capacity)
+    {
+        if (sqrDistance < search->sqrDistances[0])
+        {
+            replaceKDFarthest(search, point, sqrDistance);
+        }
+        return;
+    }
+    int index = search->size++;
+    while (index > 0 && search->sqrDistances[(index - 1) / 2] < sqrDistance)
+    {
+        search->points[index] = search->points[(index - 1) / 2];
+        search->sqrDistances[index] = search->sqrDistances[(index - 1) / 2];
+        index = (index - 1) / 2;
+    }
+    search->points[index] = point;
+    search->sqrDistances[index] = sqrDistance;
+}
+
+/**
+ * @return squared distance of the farthest of the k closest points found so far, or a distance
+ * larger than any if fewer than k points were found.
+ */
+double getKDSearchBound(const KDSearch *search)
+{
+    return (search->size < search->capacity) ? HUGE_VAL : search->sqrDistances[0];
+}
+
+/**
+ * searches the subtree of points[low, high), the side of the query first.
+ */
+void searchKDTree(KDSearch *search, int low, int high)
+{
+    while (high - low > 0)
+    {
+        int middle = low + (high - low) / 2;
+        const Vector *point = search->index->points[middle];
+        double bound = getKDSearchBound(search);
+        double sqrDistance = getKDSquaredDistance(point->vector, search->query, search->index->dim,
+                                                  bound);
+        if (sqrDistance < bound)
+        {
+            offerKDNeighbour(search, point, sqrDistance);
+        }
+        if (search->index->dim == 0)
+        {
+            searchKDTree(search, low, middle);
+            low = middle + 1;
+            continue;
+        }
+        int axis = search->index->axes[middle];
+        double diff = search->query[axis] - point->vector[axis];
+        int nearLow = (diff < 0) ? low : middle + 1;
+        int nearHigh = (diff < 0) ? middle : high;
+        searchKDTree(search, nearLow, nearHigh);
+        // the far side is searched only if the splitting plane is closer than the bound.
+        if (diff * diff >= getKDSearchBound(search))
+        {
+            return;
+        }
+        low = (diff < 0) ? middle + 1 : low;
+        high = (diff < 0) ? high : middle;
+    }
+}
+
+int knnSearch(const KDTree *index, const Vector *q, int k, const Vector **neighbours,
+              double *sqrDistances)
+{
+    if (index == NULL || q == NULL || neighbours == NULL || k <= 0 || q->len != index->dim)
+    {
+        return 0;
+    }
+    int capacity = (k < index->size) ? k : index->size;
+    KDSearch search = {index, q->vector, neighbours, sqrDistances, 0, capacity};
+    if (sqrDistances == NULL)
+    {
+        search.sqrDistances = (double *) malloc((capacity > 0 ? capacity : 1) * sizeof(double));
+        if (search.sqrDistances == NULL)
+        {
+            return 0;
+        }
+    }
+    if (capacity > 0 && index->dim < KD_SCAN_DIM)
+    {
+        searchKDTree(&search, 0, index->size);
+    }
+    else if (capacity > 0)
+    {
+        for (int i = 0; i < index->size; i++)
+        {
+            double bound = getKDSearchBound(&search);
+            double sqrDistance = getKDSquaredDistance(index->points[i]->vector, search.query,
+                                                      index->dim, bound);
+            if (sqrDistance < bound)
+            {
+                offerKDNeighbour(&search, index->points[i], sqrDistance);
+            }
+        }
+    }
+    // sort the heap in place: move the farthest point to the end each time.
+    for (int end = search.size - 1; end > 0; end--)
+    {
+        const Vector *farthest = search.points[0];
+        double farthestDistance = search.sqrDistances[0];
+        search.size = end;
+        replaceKDFarthest(&search, search.points[end], search.sqrDistances[end]);
+        search.points[end] = farthest;
+        search.sqrDistances[end] = farthestDistance;
+    }
+    if (sqrDistances == NULL)
+    {
+        free(search.sqrDistances);
+    }
+    return capacity;
+}
+
+void freeKDTree(KDTree *index)
+{
+    if (index != NULL)
+    {
+        free(index->points);
+        free(index->axes);
+        free(index);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef TA_EX3_KDTREE_H
+#define TA_EX3_KDTREE_H
+
+#include "Structs.h"
+
+/**
+ * a KD tree over Vectors of the same length, for nearest neighbour queries by L2 distance.
+ * the tree is implicit in the points array: the root of a range of points is the middle point,
+ * which is the median of the range along the axis of that node, the points before it are the left
+ * subtree and the points after it the right subtree. the Vectors are not owned by the tree and
+ * must outlive it. in 10 dimensions and more pruning rarely pays off, so the points are kept
+ * unordered and scanned.
+ */
+typedef struct KDTree
+{
+	const Vector **points;
+	int *axes; // axes[i] is the axis that splits the subtree rooted at points[i].
+	int size;
+	int dim;
+} KDTree;
+
+/**
+ * builds a KD tree over the given vectors in O(n log n): every range is split at its median along
+ * the axis in which its points are spread the most.
+ * @param vectors: array of pointers to vectors, all of the same length.
+ * @param n: number of vectors.
+ * @return: the new tree, NULL on failure or if the lengths differ.
+ */
+KDTree *newKDTree(Vector *const *vectors, int n);
+
+/**
+ * builds a KD tree over all the vectors of a tree of Vectors, see newKDTree.
+ * @param tree: a tree of Vectors, all of the same length.
+ * @return: the new tree, NULL on failure or if the lengths differ.
+ */
+KDTree *newKDTreeFromRBTree(RBTree *tree);
+
+/**
+ * finds the k vectors closest to q by L2 distance. subtrees that can't hold a point closer than
+ * the k-th closest found so far are skipped, so a query in a low dimension visits O(log n + k)
+ * points on average instead of all of them. the distance to a point is abandoned as soon as it
+ * passes that of the k-th closest.
+ * @param index: the tree to search.
+ * @param q: the query vector, of the same length as the vectors of the tree.
+ * @param k: number of neighbours to find.
+ * @param neighbours: array of k pointers, will be filled with the neighbours from the closest.
+ * @param sqrDistances: array of k doubles, will be filled with their squared distances (or NULL).
+ * @return: number of neighbours found, min(k, size). 0 on failure.
+ */
+int knnSearch(const KDTree *index, const Vector *q, int k, const Vector **neighbours,
+			  double *sqrDistances);
+
+/**
+ * free all memory of the tree (but not its vectors).
+ * @param index: the tree to free.
+ */
+void freeKDTree(KDTree *index);
+
+#endif //TA_EX3_KDTREE_H
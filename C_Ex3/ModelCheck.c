@@ -0,0 +1,1086 @@
+#include "RBTree.h"
+#include "RadixTree.h"
+#include "KDTree.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_ITEMS 2000
+#define NUM_QUERIES 500
+#define VALUE_RANGE 5000 // the values of the sum tree are in [0, VALUE_RANGE), some repeat.
+#define INTERVAL_RANGE 10000 // the low endpoints are in [0, INTERVAL_RANGE).
+#define MAX_INTERVAL_LEN 300
+#define MAX_KEY_LEN 12
+#define KEY_ALPHABET "abc" // a small alphabet, so many keys share prefixes.
+#define STRING_STEM "https://www.example.org/" // string keys are prefixes of it and a tail.
+#define STRING_TAIL_ALPHABET "a~\xe9" // '\xe9' is above 127, a negative char where char is signed.
+#define MAX_STRING_TAIL 3
+#define NUM_POINTS 1000
+#define COORDINATE_RANGE 20 // small integer coordinates, so many distances are equal.
+#define MAX_K (NUM_POINTS + 1)
+
+/**
+ * aggregate of a subtree of ints: their sum and their number.
+ */
+typedef struct SumAggregate
+{
+	long long sum;
+	int count;
+} SumAggregate;
+
+/**
+ * an item of the key trees, the int key tree is ordered by intKey and the double key tree by
+ * doubleKey.
+ */
+typedef struct ModelKeyItem
+{
+	int64_t intKey;
+	double doubleKey;
+} ModelKeyItem;
+
+/**
+ * an item of the interval tree, ordered by its low endpoint and then by its id.
+ */
+typedef struct ModelInterval
+{
+	double low;
+	double high;
+	int id;
+} ModelInterval;
+
+/**
+ * the items a forEach reached, in the order it reached them.
+ */
+typedef struct ModelVisit
+{
+	const void **items;
+	int count;
+	int capacity;
+} ModelVisit;
+
+/**
+ * the strings a forEach of a RadixTree should reach, in order, and whether it reached them.
+ */
+typedef struct ModelKeys
+{
+	char **keys;
+	int count;
+	int next;
+	int inOrder;
+} ModelKeys;
+
+int failures = 0;
+
+/**
+ * counts and reports a failed check.
+ * @param passed other than 0 if the check passed.
+ * @param msg what was checked.
+ */
+void check(int passed, const char *msg)
+{
+	if (!passed)
+	{
+		printf("check failed: %s\n", msg);
+		failures++;
+	}
+}
+
+/**
+ * @return a uniform random int in [0, n).
+ */
+int randomBelow(int n)
+{
+	return (int) ((double) rand() / ((double) RAND_MAX + 1) * n);
+}
+
+/**
+ * ForEach function that records the items it is activated on.
+ * @param item the item.
+ * @param pVisit ModelVisit*
+ * @return 0 if there are more items than expected, 1 otherwise.
+ */
+int visitItem(const void *item, void *pVisit)
+{
+	ModelVisit *visit = (ModelVisit *) pVisit;
+	if (visit->count == visit->capacity)
+	{
+		return 0;
+	}
+	visit->items[visit->count++] = item;
+	return 1;
+}
+
+/**
+ * CompareFunc for ints.
+ */
+int modelIntCompare(const void *a, const void *b)
+{
+	int first = *(const int *) a;
+	int second = *(const int *) b;
+	return (first > second) - (first < second);
+}
+
+/**
+ * CombineFunc of a tree of ints, sums the subtree.
+ */
+void combineSum(void *aggregate, const void *data, const void *leftAggregate,
+				const void *rightAggregate, void *args)
+{
+	(void) args;
+	SumAggregate *result = (SumAggregate *) aggregate;
+	result->sum = *(const int *) data;
+	result->count = 1;
+	if (leftAggregate != NULL)
+	{
+		result->sum += ((const SumAggregate *) leftAggregate)->sum;
+		result->count += ((const SumAggregate *) leftAggregate)->count;
+	}
+	if (rightAggregate != NULL)
+	{
+		result->sum += ((const SumAggregate *) rightAggregate)->sum;
+		result->count += ((const SumAggregate *) rightAggregate)->count;
+	}
+}
+
+/**
+ * adds a value to a sum tree and to its model, and checks the whole tree aggregate, which every
+ * rotation of the insertion has to keep.
+ * @param model - the values in the tree, in the order they were added.
+ * @param n - number of values in model, updated if the value is added.
+ * @param total - sum of the values in model, updated if the value is added.
+ */
+void addToSumTree(RBTree *tree, int value, int *model, int *n, long long *total)
+{
+	int *item = (int *) malloc(sizeof(int));
+	if (item == NULL)
+	{
+		check(0, "int allocation");
+		return;
+	}
+	*item = value;
+	int isNew = 1;
+	for (int i = 0; isNew && i < *n; i++)
+	{
+		isNew = (model[i] != value);
+	}
+	check((addToRBTree(tree, item) != 0) == isNew, "addToRBTree fails iff the value is in");
+	if (!isNew)
+	{
+		free(item);
+		return;
+	}
+	model[(*n)++] = value;
+	*total += value;
+	const SumAggregate *aggregate = (const SumAggregate *) getRBTreeAggregate(tree);
+	check(aggregate != NULL && aggregate->sum == *total && aggregate->count == *n,
+		  "getRBTreeAggregate is the sum of the tree");
+}
+
+/**
+ * checks the aggregates of an augmented tree of ints that sums its subtrees: the whole tree
+ * aggregate after every insertion, with random values and with ascending and descending runs that
+ * rotate the tree on both sides, and aggregateRangeRBTree against a sum over all the values, on
+ * random ranges, empty ones and reversed ones included.
+ */
+void checkSumAggregates()
+{
+	RBTree *tree = newAugmentedRBTree(modelIntCompare, free, combineSum, sizeof(SumAggregate),
+									  NULL);
+	int *model = (int *) malloc(NUM_ITEMS * sizeof(int));
+	if (tree == NULL || model == NULL)
+	{
+		check(0, "sum tree allocation");
+		freeRBTree(tree);
+		free(model);
+		return;
+	}
+	check(getRBTreeAggregate(tree) == NULL, "getRBTreeAggregate of an empty tree");
+	int n = 0;
+	long long total = 0;
+	for (int i = 0; i < NUM_ITEMS / 2; i++)
+	{
+		addToSumTree(tree, randomBelow(VALUE_RANGE), model, &n, &total);
+	}
+	for (int i = 0; i < NUM_ITEMS / 4; i++)
+	{
+		addToSumTree(tree, VALUE_RANGE + i, model, &n, &total);
+	}
+	for (int i = 0; i < NUM_ITEMS / 4; i++)
+	{
+		addToSumTree(tree, -1 - i, model, &n, &total);
+	}
+
+	for (int q = 0; q < NUM_QUERIES; q++)
+	{
+		int low = randomBelow(VALUE_RANGE + NUM_ITEMS) - NUM_ITEMS / 2;
+		int high = low + randomBelow(VALUE_RANGE / 4) - ((q % 8 == 0) ? VALUE_RANGE / 8 : 0);
+		SumAggregate expected = {0, 0};
+		for (int i = 0; i < n; i++)
+		{
+			if (model[i] >= low && model[i] <= high)
+			{
+				expected.sum += model[i];
+				expected.count++;
+			}
+		}
+		SumAggregate range = {0, 0};
+		int found = aggregateRangeRBTree(tree, &low, &high, &range);
+		check((found != 0) == (expected.count > 0),
+			  "aggregateRangeRBTree finds items iff any are in range");
+		check(!found || (range.sum == expected.sum && range.count == expected.count),
+			  "aggregateRangeRBTree is the sum of the range");
+	}
+	freeRBTree(tree);
+	free(model);
+}
+
+/**
+ * checks the red black invariants of a subtree and its links: the children of a red node are
+ * black, every path has the same number of black nodes, every child points to its parent, and the
+ * items are strictly ascending in order.
+ * @param compare - the order of the items.
+ * @param node - root of the subtree.
+ * @param prev - the last node before the subtree in order, updated to the last node of it.
+ * @param count - incremented for every node of the subtree.
+ * @return the number of black nodes in every path of the subtree, -1 if the subtree is invalid.
+ */
+int checkSubTree(CompareFunc compare, const Node *node, const Node **prev, int *count)
+{
+	if (node == NULL)
+	{
+		return 0;
+	}
+	if ((node->left != NULL && node->left->parent != node) ||
+		(node->right != NULL && node->right->parent != node))
+	{
+		return -1;
+	}
+	if (node->color == RED && ((node->left != NULL && node->left->color == RED) ||
+							   (node->right != NULL && node->right->color == RED)))
+	{
+		return -1;
+	}
+	int leftHeight = checkSubTree(compare, node->left, prev, count);
+	if (*prev != NULL && compare((*prev)->data, node->data) >= 0)
+	{
+		return -1;
+	}
+	*prev = node;
+	(*count)++;
+	int rightHeight = checkSubTree(compare, node->right, prev, count);
+	if (leftHeight < 0 || leftHeight != rightHeight)
+	{
+		return -1;
+	}
+	return leftHeight + (node->color == BLACK);
+}
+
+/**
+ * checks that a tree is a valid red black tree of size items in the given order, and that maxNode
+ * is the node of the largest item.
+ */
+void checkRBInvariants(const RBTree *tree, CompareFunc compare, const char *msg)
+{
+	const Node *last = NULL;
+	int count = 0;
+	int valid = (tree->root == NULL || (tree->root->parent == NULL && tree->root->color == BLACK));
+	valid = valid && checkSubTree(compare, tree->root, &last, &count) >= 0 && count == tree->size;
+	check(valid, msg);
+	check(tree->maxNode == last, "maxNode is the node of the largest item");
+}
+
+/**
+ * @return a node of the tree reached by a random walk down from the root, NULL for an empty tree.
+ */
+Node *randomNode(const RBTree *tree)
+{
+	Node *node = tree->root;
+	while (node != NULL && randomBelow(4) != 0)
+	{
+		Node *child = randomBelow(2) ? node->left : node->right;
+		if (child == NULL)
+		{
+			break;
+		}
+		node = child;
+	}
+	return node;
+}
+
+/**
+ * adds a value to a tree of ints, with the given hint or with addToRBTree for NO_HINT, and checks
+ * that it's added iff it's new and that lastAdded is its node.
+ * @param model - flags of the values in the tree, by value.
+ */
+void addHinted(RBTree *tree, int value, Node *hint, int useHint, char *model)
+{
+	int *item = (int *) malloc(sizeof(int));
+	if (item == NULL)
+	{
+		check(0, "int allocation");
+		return;
+	}
+	*item = value;
+	int added = useHint ? addToRBTreeHint(tree, item, hint) : addToRBTree(tree, item);
+	check((added != 0) == !model[value], "adding fails iff the value is in");
+	if (!added)
+	{
+		free(item);
+		return;
+	}
+	model[value] = 1;
+	check(tree->lastAdded != NULL && tree->lastAdded->data == item, "lastAdded is the new node");
+}
+
+/**
+ * adds NUM_ITEMS values to a tree of ints, mixing plain insertions of random values, appends,
+ * insertions next to lastAdded with it as the hint, and insertions with random, NULL and far away
+ * hints, and checks the tree every few insertions.
+ * @param model - flags of the values in the tree, by value, VALUE_RANGE of them.
+ */
+void addMixedInserts(RBTree *tree, char *model)
+{
+	int last = VALUE_RANGE / 2;
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		int value;
+		switch (randomBelow(5))
+		{
+			case 0:
+				value = randomBelow(VALUE_RANGE);
+				addHinted(tree, value, NULL, 0, model);
+				break;
+			case 1:
+				value = (last + 1 + randomBelow(3)) % VALUE_RANGE;
+				addHinted(tree, value, NULL, 0, model);
+				break;
+			case 2:
+				value = (last + VALUE_RANGE - 3 + randomBelow(7)) % VALUE_RANGE;
+				addHinted(tree, value, tree->lastAdded, 1, model);
+				break;
+			case 3:
+				value = randomBelow(VALUE_RANGE);
+				addHinted(tree, value, randomNode(tree), 1, model);
+				break;
+			default:
+				value = randomBelow(VALUE_RANGE);
+				addHinted(tree, value, randomBelow(2) ? NULL : tree->maxNode, 1, model);
+				break;
+		}
+		last = value;
+		if (i % 64 == 0)
+		{
+			checkRBInvariants(tree, modelIntCompare, "mixed inserts keep a valid red black tree");
+		}
+	}
+	checkRBInvariants(tree, modelIntCompare, "mixed inserts keep a valid red black tree");
+}
+
+/**
+ * checks hinted insertion, the append fast path and addSortedToRBTree: the red black invariants,
+ * maxNode and lastAdded after mixed hinted and plain insertions, after building a tree of every
+ * size up to a few levels with addSortedToRBTree (which must reject unsorted input and non empty
+ * trees), and after more mixed insertions into the built tree.
+ */
+void checkHintedInserts()
+{
+	char *model = (char *) calloc(VALUE_RANGE, 1);
+	int *values = (int *) malloc(VALUE_RANGE * sizeof(int));
+	RBTree *tree = newRBTree(modelIntCompare, free);
+	if (model == NULL || values == NULL || tree == NULL)
+	{
+		check(0, "hint tree allocation");
+		free(model);
+		free(values);
+		freeRBTree(tree);
+		return;
+	}
+	addMixedInserts(tree, model);
+	freeRBTree(tree);
+
+	for (int n = 0; n <= 70; n++)
+	{
+		memset(model, 0, VALUE_RANGE);
+		void **items = (void **) malloc((n + 1) * sizeof(void *));
+		tree = newRBTree(modelIntCompare, free);
+		if (items == NULL || tree == NULL)
+		{
+			check(0, "sorted tree allocation");
+			free(items);
+			freeRBTree(tree);
+			continue;
+		}
+		for (int i = 0; i < n; i++)
+		{
+			values[i] = 2 * i + randomBelow(2);
+			items[i] = &values[i];
+		}
+		if (n >= 2) // a duplicate and a swap must both be rejected, leaving the tree empty.
+		{
+			values[n] = values[n - 2];
+			items[n - 1] = &values[n];
+			check(!addSortedToRBTree(tree, items, n) && tree->size == 0 && tree->root == NULL,
+				  "addSortedToRBTree rejects a duplicate");
+			items[n - 1] = items[0];
+			items[0] = &values[n - 1];
+			check(!addSortedToRBTree(tree, items, n) && tree->size == 0 && tree->root == NULL,
+				  "addSortedToRBTree rejects unsorted items");
+		}
+		for (int i = 0; i < n; i++)
+		{
+			items[i] = malloc(sizeof(int));
+			if (items[i] == NULL)
+			{
+				check(0, "int allocation");
+				n = i;
+				break;
+			}
+			*(int *) items[i] = values[i];
+			model[values[i]] = 1;
+		}
+		check(addSortedToRBTree(tree, items, n), "addSortedToRBTree status");
+		checkRBInvariants(tree, modelIntCompare, "addSortedToRBTree builds a valid red black tree");
+		check(tree->lastAdded == tree->maxNode, "lastAdded of a sorted tree is its max");
+		if (n > 0)
+		{
+			check(!addSortedToRBTree(tree, items, n), "addSortedToRBTree rejects a non empty tree");
+		}
+		free(items);
+		if (n % 10 == 0)
+		{
+			addMixedInserts(tree, model);
+		}
+		freeRBTree(tree);
+	}
+	free(model);
+	free(values);
+}
+
+/**
+ * IntKeyFunc of ModelKeyItems.
+ */
+int64_t getModelIntKey(const void *item)
+{
+	return ((const ModelKeyItem *) item)->intKey;
+}
+
+/**
+ * DoubleKeyFunc of ModelKeyItems.
+ */
+double getModelDoubleKey(const void *item)
+{
+	return ((const ModelKeyItem *) item)->doubleKey;
+}
+
+/**
+ * CompareFunc for ModelKeyItems by intKey.
+ */
+int modelIntKeyCompare(const void *a, const void *b)
+{
+	int64_t first = getModelIntKey(a);
+	int64_t second = getModelIntKey(b);
+	return (first > second) - (first < second);
+}
+
+/**
+ * CompareFunc for ModelKeyItems by doubleKey.
+ */
+int modelDoubleKeyCompare(const void *a, const void *b)
+{
+	double first = getModelDoubleKey(a);
+	double second = getModelDoubleKey(b);
+	return (first > second) - (first < second);
+}
+
+/**
+ * CompareFunc for qsort of an array of ModelKeyItem pointers, by doubleKey.
+ */
+int modelDoubleKeyPointerCompare(const void *a, const void *b)
+{
+	return modelDoubleKeyCompare(*(ModelKeyItem *const *) a, *(ModelKeyItem *const *) b);
+}
+
+/**
+ * CompareFunc for qsort of an array of ModelKeyItem pointers, by intKey.
+ */
+int modelIntKeyPointerCompare(const void *a, const void *b)
+{
+	return modelIntKeyCompare(*(ModelKeyItem *const *) a, *(ModelKeyItem *const *) b);
+}
+
+/**
+ * fills an item with random keys from a small range, so many of them are equal: int keys of
+ * either sign, some beyond 32 bits, and double keys of either sign, -0.0 (equal to 0.0) included.
+ */
+void randomKeyItem(ModelKeyItem *item)
+{
+	item->intKey = randomBelow(VALUE_RANGE) - VALUE_RANGE / 2;
+	if (randomBelow(4) == 0)
+	{
+		item->intKey *= (int64_t) 1 << 40;
+	}
+	item->doubleKey = (randomBelow(VALUE_RANGE) - VALUE_RANGE / 2) / 8.0;
+	if (item->doubleKey == 0 && randomBelow(2) == 0)
+	{
+		item->doubleKey = -0.0;
+	}
+}
+
+/**
+ * checks an int or a double key tree against an array of the items added to it: adding (plainly
+ * or with a random hint) fails iff an item with an equal key was added, the tree is a valid red
+ * black tree in key order, containsRBTree answers as a scan of the array, and forEachRBTree
+ * reaches the items in key order. a tree of the same items built by addSortedToRBTree is checked
+ * as well.
+ * @param doubleKeys - 0 for an int key tree, other for a double key tree.
+ */
+void checkKeyTree(int doubleKeys)
+{
+	CompareFunc compare = doubleKeys ? modelDoubleKeyCompare : modelIntKeyCompare;
+	RBTree *tree = doubleKeys ? newDoubleKeyRBTree(getModelDoubleKey, free)
+							  : newIntKeyRBTree(getModelIntKey, free);
+	RBTree *sorted = doubleKeys ? newDoubleKeyRBTree(getModelDoubleKey, NULL)
+								: newIntKeyRBTree(getModelIntKey, NULL);
+	ModelKeyItem **model = (ModelKeyItem **) malloc(NUM_ITEMS * sizeof(ModelKeyItem *));
+	ModelVisit visit = {(const void **) malloc(NUM_ITEMS * sizeof(void *)), 0, NUM_ITEMS};
+	if (tree == NULL || sorted == NULL || model == NULL || visit.items == NULL)
+	{
+		check(0, "key tree allocation");
+		freeRBTree(tree);
+		freeRBTree(sorted);
+		free(model);
+		free(visit.items);
+		return;
+	}
+	int n = 0;
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		ModelKeyItem *item = (ModelKeyItem *) malloc(sizeof(ModelKeyItem));
+		if (item == NULL)
+		{
+			check(0, "key item allocation");
+			break;
+		}
+		randomKeyItem(item);
+		int isNew = 1;
+		for (int j = 0; isNew && j < n; j++)
+		{
+			isNew = (compare(model[j], item) != 0);
+		}
+		int added = (i % 3 == 0) ? addToRBTreeHint(tree, item, randomNode(tree))
+								 : addToRBTree(tree, item);
+		check((added != 0) == isNew, "adding to a key tree fails iff the key is in");
+		if (!added)
+		{
+			free(item);
+			continue;
+		}
+		model[n++] = item;
+	}
+	checkRBInvariants(tree, compare, "a key tree is a valid red black tree in key order");
+
+	for (int i = 0; i < n; i++)
+	{
+		check(containsRBTree(tree, model[i]), "containsRBTree of an added key");
+	}
+	for (int q = 0; q < NUM_QUERIES; q++)
+	{
+		ModelKeyItem probe;
+		randomKeyItem(&probe);
+		int expected = 0;
+		for (int i = 0; !expected && i < n; i++)
+		{
+			expected = (compare(model[i], &probe) == 0);
+		}
+		check((containsRBTree(tree, &probe) != 0) == expected, "containsRBTree of a random key");
+	}
+
+	qsort(model, n, sizeof(ModelKeyItem *),
+		  doubleKeys ? modelDoubleKeyPointerCompare : modelIntKeyPointerCompare);
+	check(forEachRBTree(tree, visitItem, &visit), "forEachRBTree status");
+	int same = (visit.count == n);
+	for (int i = 0; same && i < n; i++)
+	{
+		same = (visit.items[i] == model[i]);
+	}
+	check(same, "forEachRBTree reaches a key tree in key order");
+
+	check(addSortedToRBTree(sorted, (void **) model, n), "addSortedToRBTree of a key tree");
+	checkRBInvariants(sorted, compare, "a sorted key tree is a valid red black tree in key order");
+	for (int i = 0; i < n; i++)
+	{
+		check(containsRBTree(sorted, model[i]), "containsRBTree of a sorted key tree");
+	}
+	freeRBTree(sorted);
+	freeRBTree(tree);
+	free(model);
+	free(visit.items);
+}
+
+/**
+ * CompareFunc for ModelIntervals.
+ */
+int modelIntervalCompare(const void *a, const void *b)
+{
+	const ModelInterval *first = (const ModelInterval *) a;
+	const ModelInterval *second = (const ModelInterval *) b;
+	if (first->low != second->low)
+	{
+		return (first->low < second->low) ? -1 : 1;
+	}
+	return (first->id > second->id) - (first->id < second->id);
+}
+
+/**
+ * IntervalFunc for ModelIntervals.
+ */
+void getModelInterval(const void *data, double *low, double *high)
+{
+	*low = ((const ModelInterval *) data)->low;
+	*high = ((const ModelInterval *) data)->high;
+}
+
+/**
+ * CompareFunc for qsort of an array of ModelInterval pointers.
+ */
+int modelIntervalPointerCompare(const void *a, const void *b)
+{
+	return modelIntervalCompare(*(ModelInterval *const *) a, *(ModelInterval *const *) b);
+}
+
+/**
+ * checks forEachOverlapping of an interval tree against a scan of all the intervals: both must
+ * reach the same intervals, in ascending order. the intervals have integer endpoints from a small
+ * range, so many of them share endpoints with each other and with the queries.
+ */
+void checkIntervalTree()
+{
+	RBTree *tree = newIntervalRBTree(modelIntervalCompare, free, getModelInterval);
+	ModelInterval **model = (ModelInterval **) malloc(NUM_ITEMS * sizeof(ModelInterval *));
+	const void **expected = (const void **) malloc(NUM_ITEMS * sizeof(void *));
+	ModelVisit visit = {(const void **) malloc(NUM_ITEMS * sizeof(void *)), 0, NUM_ITEMS};
+	if (tree == NULL || model == NULL || expected == NULL || visit.items == NULL)
+	{
+		check(0, "interval tree allocation");
+		freeRBTree(tree);
+		free(model);
+		free(expected);
+		free(visit.items);
+		return;
+	}
+	int n = 0;
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		ModelInterval *interval = (ModelInterval *) malloc(sizeof(ModelInterval));
+		if (interval == NULL)
+		{
+			check(0, "interval allocation");
+			break;
+		}
+		interval->low = randomBelow(INTERVAL_RANGE);
+		interval->high = interval->low + randomBelow(MAX_INTERVAL_LEN);
+		interval->id = i;
+		if (!addToRBTree(tree, interval))
+		{
+			check(0, "addToRBTree of an interval");
+			free(interval);
+			continue;
+		}
+		model[n++] = interval;
+	}
+	check(tree->size == n, "interval tree size");
+	qsort(model, n, sizeof(ModelInterval *), modelIntervalPointerCompare);
+
+	for (int q = 0; q < NUM_QUERIES; q++)
+	{
+		double low = randomBelow(INTERVAL_RANGE + MAX_INTERVAL_LEN);
+		double high = low + ((q % 4 == 0) ? 0 : randomBelow(2 * MAX_INTERVAL_LEN));
+		int nExpected = 0;
+		for (int i = 0; i < n; i++)
+		{
+			if (model[i]->low <= high && model[i]->high >= low)
+			{
+				expected[nExpected++] = model[i];
+			}
+		}
+		visit.count = 0;
+		check(forEachOverlapping(tree, low, high, visitItem, &visit), "forEachOverlapping status");
+		int same = (visit.count == nExpected);
+		for (int i = 0; same && i < nExpected; i++)
+		{
+			same = (visit.items[i] == expected[i]);
+		}
+		check(same, "forEachOverlapping reaches the overlapping intervals in order");
+	}
+	freeRBTree(tree);
+	free(model);
+	free(expected);
+	free(visit.items);
+}
+
+/**
+ * ForEach function of a RadixTree that compares every string with the next expected one.
+ * @param key the string, valid only during the call.
+ * @param pKeys ModelKeys*
+ * @return 1
+ */
+int matchKey(const void *key, void *pKeys)
+{
+	ModelKeys *keys = (ModelKeys *) pKeys;
+	if (keys->next == keys->count || strcmp((const char *) key, keys->keys[keys->next]) != 0)
+	{
+		keys->inOrder = 0;
+	}
+	keys->next++;
+	return 1;
+}
+
+/**
+ * CompareFunc for qsort of an array of strings.
+ */
+int modelKeyCompare(const void *a, const void *b)
+{
+	return strcmp(*(char *const *) a, *(char *const *) b);
+}
+
+/**
+ * fills a buffer with a random string of up to MAX_KEY_LEN letters of KEY_ALPHABET, it may be
+ * empty.
+ * @param key buffer of MAX_KEY_LEN + 1 chars.
+ */
+void randomKey(char *key)
+{
+	int len = randomBelow(MAX_KEY_LEN + 1);
+	for (int i = 0; i < len; i++)
+	{
+		key[i] = KEY_ALPHABET[randomBelow((int) strlen(KEY_ALPHABET))];
+	}
+	key[len] = '\0';
+}
+
+/**
+ * @return the index of key in the first n strings of keys, -1 if it isn't there.
+ */
+int findModelKey(char **keys, int n, const char *key)
+{
+	for (int i = 0; i < n; i++)
+	{
+		if (strcmp(keys[i], key) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/**
+ * checks a RadixTree against an array of the strings added to it: adding a string fails iff the
+ * array has it, containsRadixTree answers as a scan of the array on added and random strings, and
+ * forEachRadixTree reaches the strings of the array in strcmp order.
+ */
+void checkRadixTree()
+{
+	RadixTree *tree = newRadixTree();
+	ModelKeys model = {(char **) malloc(NUM_ITEMS * sizeof(char *)), 0, 0, 1};
+	char key[MAX_KEY_LEN + 1];
+	if (tree == NULL || model.keys == NULL)
+	{
+		check(0, "radix tree allocation");
+		freeRadixTree(tree);
+		free(model.keys);
+		return;
+	}
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		randomKey(key);
+		int isNew = (findModelKey(model.keys, model.count, key) < 0);
+		check((addToRadixTree(tree, key) != 0) == isNew, "addToRadixTree fails iff the key is in");
+		if (isNew)
+		{
+			model.keys[model.count] = (char *) malloc(strlen(key) + 1);
+			if (model.keys[model.count] == NULL)
+			{
+				check(0, "key allocation");
+				break;
+			}
+			strcpy(model.keys[model.count++], key);
+		}
+	}
+	check(tree->size == model.count, "radix tree size");
+	for (int i = 0; i < model.count; i++)
+	{
+		check(containsRadixTree(tree, model.keys[i]), "containsRadixTree of an added key");
+	}
+	for (int q = 0; q < NUM_QUERIES; q++)
+	{
+		randomKey(key);
+		int expected = (findModelKey(model.keys, model.count, key) >= 0);
+		check((containsRadixTree(tree, key) != 0) == expected, "containsRadixTree of a random key");
+	}
+
+	qsort(model.keys, model.count, sizeof(char *), modelKeyCompare);
+	check(forEachRadixTree(tree, matchKey, &model), "forEachRadixTree status");
+	check(model.inOrder && model.next == model.count, "forEachRadixTree reaches the keys in order");
+	for (int i = 0; i < model.count; i++)
+	{
+		free(model.keys[i]);
+	}
+	free(model.keys);
+	freeRadixTree(tree);
+}
+
+/**
+ * CompareFunc for strings.
+ */
+int modelStringCompare(const void *a, const void *b)
+{
+	return strcmp((const char *) a, (const char *) b);
+}
+
+/**
+ * fills a buffer with a random prefix of STRING_STEM followed by up to MAX_STRING_TAIL chars of
+ * STRING_TAIL_ALPHABET, so the strings share prefixes shorter than, as long as and longer than the
+ * prefix a string tree caches, and some differ only in their length.
+ * @param key buffer of sizeof(STRING_STEM) + MAX_STRING_TAIL chars.
+ */
+void randomStringKey(char *key)
+{
+	int stemLen = randomBelow((int) strlen(STRING_STEM) + 1);
+	int tailLen = randomBelow(MAX_STRING_TAIL + 1);
+	memcpy(key, STRING_STEM, stemLen);
+	for (int i = 0; i < tailLen; i++)
+	{
+		key[stemLen + i] = STRING_TAIL_ALPHABET[randomBelow((int) strlen(STRING_TAIL_ALPHABET))];
+	}
+	key[stemLen + tailLen] = '\0';
+}
+
+/**
+ * checks a string tree against an array of the strings added to it: adding (plainly or with a
+ * random hint) fails iff the array has the string, the tree is a valid red black tree in strcmp
+ * order, containsRBTree answers as a scan of the array on added and random strings, and
+ * forEachRBTree reaches the strings in strcmp order. a tree of the same strings built by
+ * addSortedToRBTree is checked as well.
+ */
+void checkStringTree()
+{
+	RBTree *tree = newStringRBTree(free);
+	RBTree *sorted = newStringRBTree(NULL);
+	char **model = (char **) malloc(NUM_ITEMS * sizeof(char *));
+	ModelVisit visit = {(const void **) malloc(NUM_ITEMS * sizeof(void *)), 0, NUM_ITEMS};
+	char key[sizeof(STRING_STEM) + MAX_STRING_TAIL];
+	if (tree == NULL || sorted == NULL || model == NULL || visit.items == NULL)
+	{
+		check(0, "string tree allocation");
+		freeRBTree(tree);
+		freeRBTree(sorted);
+		free(model);
+		free(visit.items);
+		return;
+	}
+	int n = 0;
+	for (int i = 0; i < NUM_ITEMS; i++)
+	{
+		randomStringKey(key);
+		int isNew = (findModelKey(model, n, key) < 0);
+		char *copy = (char *) malloc(strlen(key) + 1);
+		if (copy == NULL)
+		{
+			check(0, "string allocation");
+			break;
+		}
+		strcpy(copy, key);
+		int added = (i % 3 == 0) ? addToRBTreeHint(tree, copy, randomNode(tree))
+								 : addToRBTree(tree, copy);
+		check((added != 0) == isNew, "adding to a string tree fails iff the string is in");
+		if (!added)
+		{
+			free(copy);
+			continue;
+		}
+		model[n++] = copy;
+	}
+	checkRBInvariants(tree, modelStringCompare, "a string tree is a valid red black tree");
+
+	for (int i = 0; i < n; i++)
+	{
+		check(containsRBTree(tree, model[i]), "containsRBTree of an added string");
+	}
+	for (int q = 0; q < NUM_QUERIES; q++)
+	{
+		randomStringKey(key);
+		int expected = (findModelKey(model, n, key) >= 0);
+		check((containsRBTree(tree, key) != 0) == expected, "containsRBTree of a random string");
+	}
+
+	qsort(model, n, sizeof(char *), modelKeyCompare);
+	check(forEachRBTree(tree, visitItem, &visit), "forEachRBTree status");
+	int same = (visit.count == n);
+	for (int i = 0; same && i < n; i++)
+	{
+		same = (visit.items[i] == model[i]);
+	}
+	check(same, "forEachRBTree reaches a string tree in strcmp order");
+
+	check(addSortedToRBTree(sorted, (void **) model, n), "addSortedToRBTree of a string tree");
+	checkRBInvariants(sorted, modelStringCompare, "a sorted string tree is a valid red black tree");
+	for (int i = 0; i < n; i++)
+	{
+		check(containsRBTree(sorted, model[i]), "containsRBTree of a sorted string tree");
+	}
+	freeRBTree(sorted);
+	freeRBTree(tree);
+	free(model);
+	free(visit.items);
+}
+
+/**
+ * CompareFunc for qsort of an array of doubles.
+ */
+int modelDistanceCompare(const void *a, const void *b)
+{
+	double first = *(const double *) a;
+	double second = *(const double *) b;
+	return (first > second) - (first < second);
+}
+
+/**
+ * @return the squared distance between two vectors of the same length.
+ */
+double modelSquaredDistance(const Vector *a, const Vector *b)
+{
+	double sum = 0;
+	for (int i = 0; i < a->len; i++)
+	{
+		sum += (a->vector[i] - b->vector[i]) * (a->vector[i] - b->vector[i]);
+	}
+	return sum;
+}
+
+/**
+ * @return a new vector in the heap with random integer coordinates, NULL on failure.
+ */
+Vector *newRandomPoint(int dim)
+{
+	Vector *v = (Vector *) malloc(sizeof(Vector));
+	double *coefficients = (double *) malloc(dim * sizeof(double));
+	if (v == NULL || coefficients == NULL)
+	{
+		free(v);
+		free(coefficients);
+		return NULL;
+	}
+	for (int i = 0; i < dim; i++)
+	{
+		coefficients[i] = randomBelow(COORDINATE_RANGE);
+	}
+	initVector(v, coefficients, dim);
+	return v;
+}
+
+/**
+ * checks knnSearch on a KD tree of a tree of points against sorting the distances to all of them:
+ * it returns min(k, n) distinct points, with their true distances, and the same distances as the
+ * sort (which points are returned among equally distant ones may differ). the dimensions include
+ * ones from which the KD tree scans all the points.
+ */
+void checkKnnSearch()
+{
+	const int dims[] = {1, 2, 3, 5, 12};
+	const int ks[] = {1, 5, 20, MAX_K};
+	const Vector **neighbours = (const Vector **) malloc(MAX_K * sizeof(Vector *));
+	double *sqrDistances = (double *) malloc(MAX_K * sizeof(double));
+	double *expected = (double *) malloc(NUM_POINTS * sizeof(double));
+	if (neighbours == NULL || sqrDistances == NULL || expected == NULL)
+	{
+		check(0, "k-NN allocation");
+		free(neighbours);
+		free(sqrDistances);
+		free(expected);
+		return;
+	}
+	for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++)
+	{
+		RBTree *tree = newRBTree(vectorCompare1By1, freeVector);
+		for (int i = 0; tree != NULL && i < NUM_POINTS; i++)
+		{
+			Vector *point = newRandomPoint(dims[d]);
+			if (point != NULL && !addToRBTree(tree, point)) // the point is already in the tree.
+			{
+				freeVector(point);
+			}
+		}
+		KDTree *index = newKDTreeFromRBTree(tree);
+		Vector **points = (tree != NULL) ? flattenVectors(tree, forEachVectorTree, tree->size) : NULL;
+		Vector *q = newRandomPoint(dims[d]);
+		if (index == NULL || points == NULL || q == NULL)
+		{
+			check(0, "KD tree allocation");
+			freeVector(q);
+			free(points);
+			freeKDTree(index);
+			freeRBTree(tree);
+			continue;
+		}
+		int n = tree->size;
+		for (int query = 0; query < NUM_QUERIES / 10; query++)
+		{
+			for (int i = 0; i < dims[d]; i++)
+			{
+				q->vector[i] = randomBelow(COORDINATE_RANGE);
+			}
+			for (int i = 0; i < n; i++)
+			{
+				expected[i] = modelSquaredDistance(points[i], q);
+			}
+			qsort(expected, n, sizeof(double), modelDistanceCompare);
+			for (size_t kIdx = 0; kIdx < sizeof(ks) / sizeof(ks[0]); kIdx++)
+			{
+				int k = ks[kIdx];
+				int count = knnSearch(index, q, k, neighbours, sqrDistances);
+				check(count == ((k < n) ? k : n), "knnSearch returns min(k, n) points");
+				int same = 1;
+				for (int i = 0; same && i < count; i++)
+				{
+					same = (sqrDistances[i] == expected[i] &&
+							modelSquaredDistance(neighbours[i], q) == sqrDistances[i]);
+					for (int j = 0; same && j < i; j++)
+					{
+						same = (neighbours[j] != neighbours[i]);
+					}
+				}
+				check(same, "knnSearch returns the closest distinct points in order");
+			}
+		}
+		freeVector(q);
+		free(points);
+		freeKDTree(index);
+		freeRBTree(tree);
+	}
+	free(neighbours);
+	free(sqrDistances);
+	free(expected);
+}
+
+/**
+ * checks every structure against a brute force model of it, on random items.
+ */
+int main()
+{
+	srand(27);
+	checkSumAggregates();
+	checkHintedInserts();
+	checkKeyTree(0);
+	checkKeyTree(1);
+	checkIntervalTree();
+	checkRadixTree();
+	checkStringTree();
+	checkKnnSearch();
+	if (failures > 0)
+	{
+		printf("%d checks failed\n", failures);
+		return 1;
+	}
+	printf("model check passed\n");
+	return 0;
+}
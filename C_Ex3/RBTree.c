@@ -1,8 +1,14 @@
 
+#define _POSIX_C_SOURCE 200809L // for pthread with -std=c99
 #include "RBTree.h"
+#include <pthread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <string.h>
+
+#define STRING_PREFIX_WORDS 2
+#define STRING_PREFIX_LEN (STRING_PREFIX_WORDS * sizeof(uint64_t))
 
 /**
  * enum classifying the problems and violations can be made when inserting a new node to an RBTree.
@@ -15,6 +21,15 @@ typedef enum
     R_PARENT_B_UNCLE
 } RBTreeCorruption;
 
+/**
+ * an item looked for in the tree, with its key already extracted when the tree caches keys.
+ */
+typedef struct Probe
+{
+    const void *data;
+    NodeKey key;
+} Probe;
+
 
 RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc)
 {
@@ -27,18 +42,267 @@ RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc)
     newTree->compFunc = compFunc;
     newTree->freeFunc = freeFunc;
     newTree->size = 0;
+    newTree->keyType = GENERIC_KEY;
+    newTree->intKeyFunc = NULL;
+    newTree->doubleKeyFunc = NULL;
+    newTree->keySize = 0;
+    newTree->maxNode = NULL;
+    newTree->lastAdded = NULL;
+    newTree->combineFunc = NULL;
+    newTree->combineArgs = NULL;
+    newTree->aggregateSize = 0;
+    newTree->intervalFunc = NULL;
+    return newTree;
+}
+
+RBTree *newIntKeyRBTree(IntKeyFunc keyFunc, FreeFunc freeFunc)
+{
+    if (keyFunc == NULL)
+    {
+        return NULL;
+    }
+    RBTree *newTree = newRBTree(NULL, freeFunc);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->keyType = INT_KEY;
+    newTree->keySize = sizeof(int64_t);
+    newTree->intKeyFunc = keyFunc;
+    return newTree;
+}
+
+RBTree *newDoubleKeyRBTree(DoubleKeyFunc keyFunc, FreeFunc freeFunc)
+{
+    if (keyFunc == NULL)
+    {
+        return NULL;
+    }
+    RBTree *newTree = newRBTree(NULL, freeFunc);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->keyType = DOUBLE_KEY;
+    newTree->keySize = sizeof(double);
+    newTree->doubleKeyFunc = keyFunc;
+    return newTree;
+}
+
+RBTree *newStringRBTree(FreeFunc freeFunc)
+{
+    RBTree *newTree = newRBTree(NULL, freeFunc);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->keyType = STRING_KEY;
+    newTree->keySize = sizeof(NodeKey);
+    return newTree;
+}
+
+/**
+ * packs the first STRING_PREFIX_LEN bytes of a string into words whose unsigned order is the
+ * strcmp order of the prefixes: the first char is the most significant byte of the first word,
+ * and the bytes after the end of a short string are zero.
+ * @param str - a string.
+ * @param key - will hold the prefix words.
+ */
+void getStringPrefix(const char *str, NodeKey *key)
+{
+    int ended = 0;
+    memset(key->stringPrefix, 0, sizeof(key->stringPrefix));
+    for (size_t i = 0; i < STRING_PREFIX_LEN; i++)
+    {
+        ended = ended || str[i] == '\0'; // the bytes after the end aren't read.
+        uint64_t *word = &key->stringPrefix[i / sizeof(uint64_t)];
+        *word = (*word << 8) | (ended ? 0 : (unsigned char) str[i]);
+    }
+}
+
+/**
+ * compares two strings whose cached prefixes are known, word by word.
+ * @return as strcmp.
+ */
+int compareStringsByPrefix(const char *a, const NodeKey *aKey, const char *b, const NodeKey *bKey)
+{
+    for (int i = 0; i < STRING_PREFIX_WORDS; i++)
+    {
+        uint64_t aWord = aKey->stringPrefix[i];
+        uint64_t bWord = bKey->stringPrefix[i];
+        if (aWord != bWord)
+        {
+            return (aWord > bWord) ? 1 : -1;
+        }
+        if ((aWord & 0xFF) == 0) // both strings end within this word.
+        {
+            return 0;
+        }
+    }
+    return strcmp(a + STRING_PREFIX_LEN, b + STRING_PREFIX_LEN);
+}
+
+/**
+ * @param node - a node of a key tree.
+ * @return the key cached right after the node, only its member in use (keySize bytes) is there.
+ */
+const NodeKey *getNodeKey(const Node *node)
+{
+    return (const NodeKey *) (node + 1);
+}
+
+/**
+ * @param tree - the tree of the node.
+ * @param node - a node of the tree, or NULL.
+ * @return the aggregate kept after the node (and after its key), NULL if node is NULL or the tree
+ * isn't augmented.
+ */
+void *getNodeAggregate(const RBTree *tree, const Node *node)
+{
+    if (node == NULL || tree->combineFunc == NULL)
+    {
+        return NULL;
+    }
+    return (char *) (node + 1) + tree->keySize;
+}
+
+/**
+ * wraps an item for searching the tree, extracting its key once if the tree caches keys.
+ * @param tree - the tree to search.
+ * @param data - the item.
+ * @return the probe.
+ */
+Probe makeProbe(const RBTree *tree, const void *data)
+{
+    Probe probe;
+    probe.data = data;
+    probe.key.intKey = 0;
+    switch (tree->keyType)
+    {
+        case INT_KEY:
+            probe.key.intKey = tree->intKeyFunc(data);
+            break;
+        case DOUBLE_KEY:
+            probe.key.doubleKey = tree->doubleKeyFunc(data);
+            break;
+        case STRING_KEY:
+            getStringPrefix((const char *) data, &probe.key);
+            break;
+        case GENERIC_KEY:
+            break;
+    }
+    return probe;
+}
+
+/**
+ * compares an item whose key is known with a probe. key trees compare the keys, so they neither
+ * call a function nor read the items themselves.
+ * @param tree - the tree of the items.
+ * @param data - an item.
+ * @param key - the key of data, unused in GENERIC_KEY trees.
+ * @param probe - the item looked for.
+ * @return equal to 0 iff data == probe item. lower than 0 if data < probe item.
+ * Greater than 0 iff probe item < data.
+ */
+int compareToProbe(const RBTree *tree, const void *data, const NodeKey *key, const Probe *probe)
+{
+    switch (tree->keyType)
+    {
+        case INT_KEY:
+            return (key->intKey > probe->key.intKey) - (key->intKey < probe->key.intKey);
+        case DOUBLE_KEY:
+            return (key->doubleKey > probe->key.doubleKey) -
+                   (key->doubleKey < probe->key.doubleKey);
+        case STRING_KEY:
+            return compareStringsByPrefix((const char *) data, key, (const char *) probe->data,
+                                          &probe->key);
+        default:
+            return tree->compFunc(data, probe->data);
+    }
+}
+
+/**
+ * compares the item of a node with a probe, by the key cached in the node in key trees.
+ * @param tree - the tree of the node.
+ * @param node - a node of the tree.
+ * @param probe - the item looked for.
+ * @return as compareToProbe.
+ */
+int compareToNode(const RBTree *tree, const Node *node, const Probe *probe)
+{
+    return compareToProbe(tree, node->data, getNodeKey(node), probe);
+}
+
+RBTree *newAugmentedRBTree(CompareFunc compFunc, FreeFunc freeFunc, CombineFunc combineFunc,
+                           size_t aggregateSize, void *combineArgs)
+{
+    if (combineFunc == NULL || aggregateSize == 0)
+    {
+        return NULL;
+    }
+    RBTree *newTree = newRBTree(compFunc, freeFunc);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->combineFunc = combineFunc;
+    newTree->combineArgs = combineArgs;
+    newTree->aggregateSize = aggregateSize;
+    return newTree;
+}
+
+/**
+ * CombineFunc of interval trees, the aggregate is the max high endpoint in the subtree.
+ * @param args - the interval tree itself, to reach its IntervalFunc.
+ */
+void combineMaxEndpoint(void *aggregate, const void *data, const void *leftAggregate,
+                        const void *rightAggregate, void *args)
+{
+    const RBTree *tree = (const RBTree *) args;
+    double low, high;
+    tree->intervalFunc(data, &low, &high);
+    double *maxHigh = (double *) aggregate;
+    *maxHigh = high;
+    if (leftAggregate != NULL && *(const double *) leftAggregate > *maxHigh)
+    {
+        *maxHigh = *(const double *) leftAggregate;
+    }
+    if (rightAggregate != NULL && *(const double *) rightAggregate > *maxHigh)
+    {
+        *maxHigh = *(const double *) rightAggregate;
+    }
+}
+
+RBTree *newIntervalRBTree(CompareFunc compFunc, FreeFunc freeFunc, IntervalFunc intervalFunc)
+{
+    if (intervalFunc == NULL)
+    {
+        return NULL;
+    }
+    RBTree *newTree = newAugmentedRBTree(compFunc, freeFunc, combineMaxEndpoint, sizeof(double),
+                                         NULL);
+    if (newTree == NULL)
+    {
+        return NULL;
+    }
+    newTree->combineArgs = newTree;
+    newTree->intervalFunc = intervalFunc;
     return newTree;
 }
 
 /**
  * constructor to a new Node in the heap, initialized with  color RED and assigned with data
  * pointer to data that the user allocated in the heap.
+ * the key of a key tree and the aggregate of an augmented tree are allocated in the same block,
+ * right after the node.
+ * @param tree - the tree the node is created for.
  * @param data - pointer to unknown type of data allocated in the heap.
+ * @param key - the key of the data, cached after the node in key trees.
  * @return pointer to a new node in heap, NULL if fails.
  */
-Node *createNewNode(void *data)
+Node *createNewNode(const RBTree *tree, void *data, NodeKey key)
 {
-    Node *newNode = (Node *) malloc(sizeof(Node));
+    Node *newNode = (Node *) malloc(sizeof(Node) + tree->keySize + tree->aggregateSize);
     if (newNode != NULL)
     {
         newNode->color = RED;
@@ -46,57 +310,70 @@ Node *createNewNode(void *data)
         newNode->left = NULL;
         newNode->right = NULL;
         newNode->parent = NULL;
+        memcpy(newNode + 1, &key, tree->keySize);
         return newNode;
     }
     return NULL;
 }
 
 /**
- * This function only adds the node to the binary tree by value,
- * this function will be called only if the node data isn't already in tree.
- * @param tree - existing tree
- * @param node - node to insert
- * @return 1 on success, 0 if the data already appears.
+ * recomputes the aggregate of a node from its data and its children aggregates.
+ * does nothing if the tree isn't augmented.
+ * @param tree - the tree of the node.
+ * @param node - a node whose children aggregates are up to date.
  */
-int addNodeByValue(RBTree *tree, Node *node)
+void updateAggregate(const RBTree *tree, Node *node)
 {
-    assert(tree != NULL && node != NULL);
-    if (tree->root == NULL)
+    if (tree->combineFunc == NULL || node == NULL)
     {
-        tree->root = node;
-        return 1;
+        return;
+    }
+    tree->combineFunc(getNodeAggregate(tree, node), node->data, getNodeAggregate(tree, node->left),
+                      getNodeAggregate(tree, node->right), tree->combineArgs);
+}
+
+/**
+ * recomputes the aggregates of all the nodes in the way from node up to the root.
+ * @param tree - the tree of the node.
+ * @param node - the lowest node whose aggregate isn't up to date.
+ */
+void updateAggregatesToRoot(const RBTree *tree, Node *node)
+{
+    if (tree->combineFunc == NULL)
+    {
+        return;
+    }
+    while (node != NULL)
+    {
+        updateAggregate(tree, node);
+        node = node->parent;
     }
+}
+
+/**
+ * finds the node under which the data should be attached as a new leaf, descending from the root.
+ * @param tree - existing tree
+ * @param probe - data to insert
+ * @param parent - will be updated with the parent of the new leaf, NULL if the tree is empty.
+ * @param toRight - will be updated with 1 if the new leaf is a right child, 0 if it's a left one.
+ * @return 1 on success, 0 if the data already appears.
+ */
+int findParentByValue(const RBTree *tree, const Probe *probe, Node **parent, int *toRight)
+{
+    assert(tree != NULL && parent != NULL && toRight != NULL);
     Node *p = tree->root;
+    *parent = NULL;
+    *toRight = 1;
     while (p != NULL)
     {
-
-        int comp = tree->compFunc(p->data, node->data);
-        if (comp < 0) // p->data < node->data
-        {
-            if (p->right == NULL)
-            {
-                p->right = node;
-                node->parent = p;
-                break;
-            }
-            else
-            {
-                p = p->right;
-            }
-        }
-        else  // p->data > node->data
+        int comp = compareToNode(tree, p, probe);
+        if (comp == 0)
         {
-            if (p->left == NULL)
-            {
-                p->left = node;
-                node->parent = p;
-                break;
-            }
-            else
-            {
-                p = p->left;
-            }
+            return 0;
         }
+        *parent = p;
+        *toRight = (comp < 0); // p->data < data
+        p = (comp < 0) ? p->right : p->left;
     }
     return 1;
 }
@@ -151,7 +428,7 @@ RBTreeCorruption findCorruption(const Node *node, const Node *uncle)
     }
 }
 
-void rotateLL(Node *node)
+void rotateLL(const RBTree *tree, Node *node)
 {
     Node *tmp = node->right;
     node->right = node->parent;
@@ -173,9 +450,11 @@ void rotateLL(Node *node)
     {
         tmp->parent = node->right;
     }
+    updateAggregate(tree, node->right);
+    updateAggregate(tree, node);
 }
 
-void rotateRR(Node *node)
+void rotateRR(const RBTree *tree, Node *node)
 {
     Node *tmp = node->left;
     node->left = node->parent;
@@ -199,9 +478,11 @@ void rotateRR(Node *node)
     {
         tmp->parent = node->left;
     }
+    updateAggregate(tree, node->left);
+    updateAggregate(tree, node);
 }
 
-void rotateLR(Node *node)
+void rotateLR(const RBTree *tree, Node *node)
 {
     Node *tmp = node->right;
     node->right = node->parent;
@@ -216,14 +497,15 @@ void rotateLR(Node *node)
     {
         tmp->parent = node->right;
     }
-    rotateRR(node);
+    updateAggregate(tree, node->right);
+    rotateRR(tree, node);
 }
 
 /**
  * looking from bottom to top.
  * @param node
  */
-void rotateRL(Node *node)
+void rotateRL(const RBTree *tree, Node *node)
 {
     Node *tmp = node->left;
     node->left = node->parent;
@@ -238,21 +520,23 @@ void rotateRL(Node *node)
     {
         tmp->parent = node->left;
     }
-    rotateLL(node);
+    updateAggregate(tree, node->left);
+    rotateLL(tree, node);
 }
 
 
 /**
  * preforms rotation on a subtree that the node grandFather is it's root.
+ * @param tree the tree of the node, aggregates of the rotated nodes are recomputed.
  * @param node violating node in tree.
  * @return Top Node after rotation in the subtree that the node grandfather was it's root.
  */
-Node *rotate(Node *node)
+Node *rotate(const RBTree *tree, Node *node)
 {
     // if node is right child of a left child
     if (node == node->parent->right && node->parent == node->parent->parent->left)
     {
-        rotateRL(node);
+        rotateRL(tree, node);
         node->color = BLACK;
         node->right->color = RED;
         return node;
@@ -260,7 +544,7 @@ Node *rotate(Node *node)
         // node is left child of a right child
     else if (node == node->parent->left && node->parent == node->parent->parent->right)
     {
-        rotateLR(node);
+        rotateLR(tree, node);
         node->color = BLACK;
         node->left->color = RED;
         return node;
@@ -270,12 +554,12 @@ Node *rotate(Node *node)
         // node is left child of a left child.
         if (node == node->parent->left && node->parent == node->parent->parent->left)
         {
-            rotateLL(node->parent);
+            rotateLL(tree, node->parent);
             node->parent->right->color = RED;
         }
         else // node is right child of a right child.
         {
-            rotateRR(node->parent);
+            rotateRR(tree, node->parent);
             node->parent->left->color = RED;
         }
         node->parent->color = BLACK;
@@ -309,41 +593,83 @@ void balanceTree(RBTree *tree, Node *node)
             break;
         case R_PARENT_B_UNCLE:
         {
-            Node *subTreeRoot = rotate(node);
+            Node *subTreeRoot = rotate(tree, node);
             tree->root = (subTreeRoot->parent == NULL) ? subTreeRoot : tree->root;
             break;
         }
     }
 }
 
-int addToRBTree(RBTree *tree, void *data)
+/**
+ * creates a node for the data, links it as a leaf under the given parent and balances the tree.
+ * @param tree - existing tree
+ * @param probe - data to insert, not in the tree yet.
+ * @param parent - a node whose child on the given side is NULL, NULL if the tree is empty.
+ * @param toRight - 1 to link the node as the right child of parent, 0 for the left one.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int attachNewNode(RBTree *tree, const Probe *probe, Node *parent, int toRight)
 {
-    if (tree == NULL || containsRBTree(tree, data) == 1)
+    Node *newNode = createNewNode(tree, (void *) probe->data, probe->key);
+    if (newNode == NULL)
     {
         return 0;
     }
-
-    Node *newNode = createNewNode(data);
-    if (newNode == NULL)
+    newNode->parent = parent;
+    if (parent == NULL)
     {
-        return 0;
+        tree->root = newNode;
     }
-    int status = addNodeByValue(tree, newNode);
-    if (status == 0) // if item is already in tree.
+    else if (toRight)
     {
-        return 0;
+        assert(parent->right == NULL);
+        parent->right = newNode;
+    }
+    else
+    {
+        assert(parent->left == NULL);
+        parent->left = newNode;
+    }
+    if (tree->maxNode == NULL || (toRight && parent == tree->maxNode))
+    {
+        tree->maxNode = newNode;
     }
+    // rotations keep the aggregates of the subtrees they touch, so the path must be valid first.
+    updateAggregatesToRoot(tree, newNode);
     balanceTree(tree, newNode);
+    tree->lastAdded = newNode;
     ++tree->size;
     return 1;
 }
 
+int addToRBTree(RBTree *tree, void *data)
+{
+    if (tree == NULL)
+    {
+        return 0;
+    }
+    Probe probe = makeProbe(tree, data);
+    Node *parent = NULL;
+    int toRight = 1;
+    // items that arrive in increasing order are appended after the max with a single comparison.
+    if (tree->maxNode != NULL && compareToNode(tree, tree->maxNode, &probe) < 0)
+    {
+        parent = tree->maxNode;
+    }
+    else if (findParentByValue(tree, &probe, &parent, &toRight) == 0) // item is already in tree.
+    {
+        return 0;
+    }
+    return attachNewNode(tree, &probe, parent, toRight);
+}
+
 int containsRBTree(RBTree *tree, void *data)
 {
+    Probe probe = makeProbe(tree, data);
     Node *p = tree->root;
     while (p != NULL)
     {
-        int cmp = tree->compFunc(p->data, data);
+        int cmp = compareToNode(tree, p, &probe);
         if (cmp == 0)
         {
             return 1;
@@ -395,6 +721,91 @@ Node *getSuccessor(const Node *node)
     return parent;
 }
 
+/**
+ * gets a node that represent a subtree root and returns the maximal node in tree.
+ * @param root - pointer to a Node
+ * @return pointer to the maximal Node in subTree.
+ */
+Node *getSubTreeMaxNode(Node *root)
+{
+    Node *p = root;
+    while (p != NULL && p->right != NULL)
+    {
+        p = p->right;
+    }
+    return p;
+}
+
+/**
+ * gets a node and returns a pointer to it's predecessor in the tree.
+ * @param node - pointer to a node.
+ * @return pointer to the node predecessor.
+ */
+Node *getPredecessor(const Node *node)
+{
+    if (node->left != NULL)
+    {
+        return getSubTreeMaxNode(node->left);
+    }
+    Node *parent = node->parent;
+    while (parent != NULL && node == parent->left)
+    {
+        node = parent;
+        parent = node->parent;
+    }
+    return parent;
+}
+
+int addToRBTreeHint(RBTree *tree, void *data, Node *hint)
+{
+    if (tree == NULL)
+    {
+        return 0;
+    }
+    if (hint == NULL)
+    {
+        return addToRBTree(tree, data);
+    }
+    Probe probe = makeProbe(tree, data);
+    int comp = compareToNode(tree, hint, &probe);
+    if (comp == 0)
+    {
+        return 0;
+    }
+    // the data belongs right after the hint iff it's smaller than the hint successor. in that case
+    // either the hint has no right child, or the successor (min of the right subtree) has no left
+    // child, and symmetrically for the predecessor.
+    if (comp < 0)
+    {
+        Node *next = (hint == tree->maxNode) ? NULL : getSuccessor(hint); // no walk up on appends.
+        int nextComp = (next == NULL) ? 1 : compareToNode(tree, next, &probe);
+        if (nextComp == 0)
+        {
+            return 0;
+        }
+        if (nextComp > 0)
+        {
+            return (hint->right == NULL) ? attachNewNode(tree, &probe, hint, 1) :
+                   attachNewNode(tree, &probe, next, 0);
+        }
+    }
+    else
+    {
+        Node *prev = getPredecessor(hint);
+        int prevComp = (prev == NULL) ? -1 : compareToNode(tree, prev, &probe);
+        if (prevComp == 0)
+        {
+            return 0;
+        }
+        if (prevComp < 0)
+        {
+            return (hint->left == NULL) ? attachNewNode(tree, &probe, hint, 0) :
+                   attachNewNode(tree, &probe, prev, 1);
+        }
+    }
+    return addToRBTree(tree, data); // the hint isn't next to the data.
+}
+
 int forEachRBTree(RBTree *tree, forEachFunc func, void *args)
 {
     Node *p = getSubTreeMinNode(tree->root);
@@ -411,31 +822,285 @@ int forEachRBTree(RBTree *tree, forEachFunc func, void *args)
     return 1;
 }
 
+const void *getRBTreeAggregate(const RBTree *tree)
+{
+    if (tree == NULL || tree->root == NULL)
+    {
+        return NULL;
+    }
+    return getNodeAggregate(tree, tree->root);
+}
+
+/**
+ * computes the aggregate of the items of a subtree that are within [low, high], where a NULL
+ * bound means the subtree isn't bounded from that side.
+ * a subtree bounded from both sides is narrowed to its first node within range, and from there
+ * each side of it is bounded only once, so the recursion follows two paths of the tree.
+ * @param tree - an augmented tree.
+ * @param node - root of the subtree.
+ * @param low - lower bound or NULL.
+ * @param high - upper bound or NULL.
+ * @param out - will hold the aggregate.
+ * @param scratch - room for two aggregates for every level of recursion below this one.
+ * @return 1 if there are items in range, 0 otherwise.
+ */
+int aggregateBounded(const RBTree *tree, const Node *node, const Probe *low, const Probe *high,
+                     void *out, char *scratch)
+{
+    while (node != NULL)
+    {
+        if (low != NULL && compareToNode(tree, node, low) < 0)
+        {
+            node = node->right;
+        }
+        else if (high != NULL && compareToNode(tree, node, high) > 0)
+        {
+            node = node->left;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (node == NULL)
+    {
+        return 0;
+    }
+    if (low == NULL && high == NULL)
+    {
+        memcpy(out, getNodeAggregate(tree, node), tree->aggregateSize);
+        return 1;
+    }
+    void *leftAggregate = scratch;
+    void *rightAggregate = scratch + tree->aggregateSize;
+    char *nextScratch = scratch + 2 * tree->aggregateSize;
+    int hasLeft = aggregateBounded(tree, node->left, low, NULL, leftAggregate, nextScratch);
+    int hasRight = aggregateBounded(tree, node->right, NULL, high, rightAggregate, nextScratch);
+    tree->combineFunc(out, node->data, hasLeft ? leftAggregate : NULL,
+                      hasRight ? rightAggregate : NULL, tree->combineArgs);
+    return 1;
+}
+
+int aggregateRangeRBTree(RBTree *tree, const void *low, const void *high, void *out)
+{
+    if (tree == NULL || tree->combineFunc == NULL || low == NULL || high == NULL || out == NULL)
+    {
+        return 0;
+    }
+    // the height of a red black tree is at most 2log(n+1).
+    int maxHeight = 2;
+    for (int n = tree->size + 1; n > 1; n /= 2)
+    {
+        maxHeight += 2;
+    }
+    char *scratch = (char *) malloc(2 * tree->aggregateSize * (maxHeight + 1));
+    if (scratch == NULL)
+    {
+        return 0;
+    }
+    Probe lowProbe = makeProbe(tree, low);
+    Probe highProbe = makeProbe(tree, high);
+    int found = aggregateBounded(tree, tree->root, &lowProbe, &highProbe, out, scratch);
+    free(scratch);
+    return found;
+}
+
 /**
- * recursively go over each node in the tree from the root and free data member with a
- * relevant free function, and than free the node itself.
+ * in order walk over the overlapping items of a subtree of an interval tree.
+ * a subtree whose max high endpoint is below low has no overlaps, and since the items are
+ * ordered by their low endpoint, once an item starts after high so does its whole right subtree.
+ * a subtree that isn't skipped holds an item that ends at or after low, but it may start after
+ * high, so this is O(log n) per overlapping item rather than O(log n + k) for all of them.
+ * @return 0 if func returned 0 for one of the items, 1 otherwise.
+ */
+int forEachOverlappingNode(const RBTree *tree, const Node *node, double low, double high,
+                           forEachFunc func, void *args)
+{
+    if (node == NULL || *(const double *) getNodeAggregate(tree, node) < low)
+    {
+        return 1;
+    }
+    if (forEachOverlappingNode(tree, node->left, low, high, func, args) == 0)
+    {
+        return 0;
+    }
+    double nodeLow, nodeHigh;
+    tree->intervalFunc(node->data, &nodeLow, &nodeHigh);
+    if (nodeLow > high)
+    {
+        return 1;
+    }
+    if (nodeHigh >= low && func(node->data, args) == 0)
+    {
+        return 0;
+    }
+    return forEachOverlappingNode(tree, node->right, low, high, func, args);
+}
+
+int forEachOverlapping(RBTree *tree, double low, double high, forEachFunc func, void *args)
+{
+    if (tree == NULL || tree->intervalFunc == NULL || func == NULL)
+    {
+        return 0;
+    }
+    return forEachOverlappingNode(tree, tree->root, low, high, func, args);
+}
+
+/**
+ * go over each node in the tree from the root and free data member with a relevant free
+ * function, and than free the node itself.
+ * the walk is iterative and needs no stack: a node with a left child is rotated right until the
+ * node on top has no left child, then it is freed and the walk continues to its right child.
+ * parent pointers and colors are ignored, so this runs in O(n) for a tree of any depth.
  * @param node - root of a subtree.
  * @param freeData function of type FreeFunc.
  */
 void freeNodes(Node *node, FreeFunc freeData)
 {
+    while (node != NULL)
+    {
+        if (node->left != NULL)
+        {
+            Node *left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        }
+        else
+        {
+            Node *right = node->right;
+            if (freeData != NULL)
+            {
+                freeData(node->data);
+            }
+            free(node);
+            node = right;
+        }
+    }
+}
+
+/**
+ * builds a balanced subtree of the nodes of items[low, high): the middle item is the root and the
+ * halves before and after it are its subtrees, so the sizes of sibling subtrees differ by at most
+ * one and every level above redDepth is full. the nodes at redDepth are colored red, all the
+ * others black, so all the paths have redDepth black nodes.
+ * @param tree - the tree the nodes are created for.
+ * @param items - items in ascending order.
+ * @param low - first index of the range.
+ * @param high - index after the range.
+ * @param depth - depth of the subtree root.
+ * @param redDepth - depth of the last level, if it isn't full.
+ * @param root - will be updated with the root of the subtree (NULL for an empty range).
+ * @return 1 on success, 0 if memory allocation failed (no nodes are left allocated then).
+ */
+int buildSortedSubTree(const RBTree *tree, void **items, int low, int high, int depth, int redDepth,
+                       Node **root)
+{
+    *root = NULL;
+    if (low >= high)
+    {
+        return 1;
+    }
+    int middle = low + (high - low) / 2;
+    Node *node = createNewNode(tree, items[middle], makeProbe(tree, items[middle]).key);
     if (node == NULL)
     {
-        return;
+        return 0;
     }
-    freeNodes(node->right, freeData);
-    freeNodes(node->left, freeData);
-    freeData(node->data);
-    free(node);
-    node = NULL;
+    node->color = (depth == redDepth) ? RED : BLACK;
+    if (buildSortedSubTree(tree, items, low, middle, depth + 1, redDepth, &node->left) == 0 ||
+        buildSortedSubTree(tree, items, middle + 1, high, depth + 1, redDepth, &node->right) == 0)
+    {
+        freeNodes(node, NULL);
+        return 0;
+    }
+    if (node->left != NULL)
+    {
+        node->left->parent = node;
+    }
+    if (node->right != NULL)
+    {
+        node->right->parent = node;
+    }
+    updateAggregate(tree, node);
+    *root = node;
+    return 1;
+}
+
+int addSortedToRBTree(RBTree *tree, void **items, int n)
+{
+    if (tree == NULL || tree->root != NULL || items == NULL || n < 0)
+    {
+        return 0;
+    }
+    for (int i = 1; i < n; i++)
+    {
+        Probe previous = makeProbe(tree, items[i - 1]);
+        Probe probe = makeProbe(tree, items[i]);
+        // not in order, or a duplicate.
+        if (compareToProbe(tree, previous.data, &previous.key, &probe) >= 0)
+        {
+            return 0;
+        }
+    }
+    int fullLevels = 0; // levels that are full in a balanced tree of n nodes: floor(log2(n + 1)).
+    while (((long) 1 << (fullLevels + 1)) - 1 <= n)
+    {
+        fullLevels++;
+    }
+    Node *root;
+    if (buildSortedSubTree(tree, items, 0, n, 0, fullLevels, &root) == 0)
+    {
+        return 0;
+    }
+    tree->root = root;
+    tree->maxNode = getSubTreeMaxNode(root);
+    tree->lastAdded = tree->maxNode;
+    tree->size = n;
+    return 1;
 }
 
 void freeRBTree(RBTree *tree)
 {
-    if (tree != NULL && tree->root != NULL)
+    if (tree != NULL)
     {
         freeNodes(tree->root, tree->freeFunc);
         free(tree);
         tree = NULL;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * thread routine of freeRBTreeDeferred.
+ * @param tree - RBTree to free.
+ * @return NULL.
+ */
+void *freeRBTreeRoutine(void *tree)
+{
+    freeRBTree((RBTree *) tree);
+    return NULL;
+}
+
+void freeRBTreeDeferred(RBTree *tree)
+{
+    if (tree == NULL)
+    {
+        return;
+    }
+    pthread_t thread;
+    pthread_attr_t attr;
+    int deferred = 0;
+    if (pthread_attr_init(&attr) == 0)
+    {
+        if (pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) == 0 &&
+            pthread_create(&thread, &attr, freeRBTreeRoutine, tree) == 0)
+        {
+            deferred = 1;
+        }
+        pthread_attr_destroy(&attr);
+    }
+    if (!deferred) // couldn't start a thread, free it here.
+    {
+        freeRBTree(tree);
+    }
+}
@@ -5,12 +5,32 @@
 #ifndef RBTREE_RBTREE_H
 #define RBTREE_RBTREE_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 // a color of a Node.
 typedef enum Color
 {
 	RED, BLACK
 } Color;
 
+// how the tree orders its items.
+typedef enum KeyType
+{
+	GENERIC_KEY, // by the CompareFunc of the tree.
+	INT_KEY, // by an integer key extracted once per item and cached in its node.
+	DOUBLE_KEY, // by a double key extracted once per item and cached in its node.
+	STRING_KEY // items are strings, the first bytes of each string are cached in its node.
+} KeyType;
+
+// a key cached in a node, the member in use depends on the KeyType of the tree.
+typedef union NodeKey
+{
+	int64_t intKey;
+	double doubleKey;
+	uint64_t stringPrefix[2]; // first 16 bytes of a string, big endian words padded with '\0'.
+} NodeKey;
+
 /**
  * a function to sort the tree items.
  * @a, @b: two items.
@@ -32,8 +52,42 @@ typedef int (*forEachFunc)(const void *object, void *args);
  */
 typedef void (*FreeFunc)(void *data);
 
+/**
+ * a function to extract the integer sort key of an item, used by key trees.
+ * @data: a pointer to an item of the tree.
+ * @return: the key, items with equal keys are considered equal.
+ */
+typedef int64_t (*IntKeyFunc)(const void *data);
+
+/**
+ * a function to extract the double sort key of an item, used by key trees.
+ * @data: a pointer to an item of the tree.
+ * @return: the key (not NaN), items with equal keys are considered equal.
+ */
+typedef double (*DoubleKeyFunc)(const void *data);
+
+/**
+ * a function to compute the aggregate of a subtree (max, sum, count...), used by augmented trees.
+ * @aggregate: the aggregate of the subtree root to fill.
+ * @data: the item stored in the subtree root.
+ * @leftAggregate: aggregate of the left subtree, NULL if there is no left child.
+ * @rightAggregate: aggregate of the right subtree, NULL if there is no right child.
+ * @args: the combineArgs given when constructing the tree.
+ */
+typedef void (*CombineFunc)(void *aggregate, const void *data, const void *leftAggregate,
+							const void *rightAggregate, void *args);
+
+/**
+ * a function to get the closed interval [low, high] an item represents, used by interval trees.
+ * @data: a pointer to an item of the tree.
+ * @low, @high: will be updated with the interval endpoints.
+ */
+typedef void (*IntervalFunc)(const void *data, double *low, double *high);
+
 /*
  * a node of the tree.
+ * key trees cache the key of data, and augmented trees keep the aggregate of the subtree, in the
+ * same allocation right after the node, so the nodes of other trees don't grow.
  */
 typedef struct Node
 {
@@ -49,9 +103,19 @@ typedef struct Node
 typedef struct RBTree
 {
 	Node *root;
-	CompareFunc compFunc;
+	CompareFunc compFunc; // NULL in key trees (keyType != GENERIC_KEY).
 	FreeFunc freeFunc;
 	int size;
+	KeyType keyType;
+	IntKeyFunc intKeyFunc; // NULL unless keyType == INT_KEY.
+	DoubleKeyFunc doubleKeyFunc; // NULL unless keyType == DOUBLE_KEY.
+	size_t keySize; // bytes of the NodeKey member cached after every node, 0 for GENERIC_KEY.
+	Node *maxNode; // node of the largest item, NULL if the tree is empty.
+	Node *lastAdded; // node of the last item added, a good hint for the next insertion.
+	CombineFunc combineFunc; // NULL if the tree isn't augmented.
+	void *combineArgs;
+	size_t aggregateSize;
+	IntervalFunc intervalFunc; // NULL if the tree isn't an interval tree.
 } RBTree;
 
 /**
@@ -60,6 +124,57 @@ typedef struct RBTree
  */
 RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc); // implement it in RBTree.c
 
+/**
+ * constructs a new RBTree ordered by an integer key. the key of every item is extracted once when
+ * it's added and cached in its node, so searches compare integers and never touch the items.
+ * @param keyFunc: extracts the key of an item.
+ * @param freeFunc: a function to free a data item.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newIntKeyRBTree(IntKeyFunc keyFunc, FreeFunc freeFunc);
+
+/**
+ * constructs a new RBTree ordered by a double key, see newIntKeyRBTree.
+ * @param keyFunc: extracts the key of an item.
+ * @param freeFunc: a function to free a data item.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newDoubleKeyRBTree(DoubleKeyFunc keyFunc, FreeFunc freeFunc);
+
+/**
+ * constructs a new RBTree of strings (assumes strings end with "\0") in lexicographic order, as
+ * strcmp orders them. the first 16 bytes of every string are cached in its node and compared as
+ * two words, the strings themselves are read (from their 17th byte) only when those prefixes are
+ * equal. strings that share longer prefixes, such as URLs of the same host, gain little.
+ * @param freeFunc: a function to free a string.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newStringRBTree(FreeFunc freeFunc);
+
+/**
+ * constructs a new augmented RBTree: every node keeps an aggregate of aggregateSize bytes that
+ * describes its whole subtree, kept up to date by combineFunc through insertions and rotations.
+ * @param compFunc: a function two compare two variables.
+ * @param freeFunc: a function to free a data item.
+ * @param combineFunc: computes a node aggregate from its data and its children aggregates.
+ * @param aggregateSize: size in bytes of a single aggregate.
+ * @param combineArgs: passed as is to every call of combineFunc (may be NULL).
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newAugmentedRBTree(CompareFunc compFunc, FreeFunc freeFunc, CombineFunc combineFunc,
+						   size_t aggregateSize, void *combineArgs);
+
+/**
+ * constructs a new interval tree: an augmented RBTree in which every node keeps the max high
+ * endpoint of its subtree, so overlap queries can skip whole subtrees.
+ * @param compFunc: a function two compare two variables, must order the items by their low
+ * endpoint first.
+ * @param freeFunc: a function to free a data item.
+ * @param intervalFunc: returns the interval of an item.
+ * @return: the new tree, NULL on failure.
+ */
+RBTree *newIntervalRBTree(CompareFunc compFunc, FreeFunc freeFunc, IntervalFunc intervalFunc);
+
 /**
  * add an item to the tree
  * @param tree: the tree to add an item to.
@@ -68,6 +183,29 @@ RBTree *newRBTree(CompareFunc compFunc, FreeFunc freeFunc); // implement it in R
  */
 int addToRBTree(RBTree *tree, void *data); // implement it in RBTree.c
 
+/**
+ * add an item to the tree, starting the search for its place from a node that is expected to be
+ * next to it in the tree order (e.g. tree->lastAdded when the items arrive nearly sorted).
+ * if the item belongs right before or after the hint it is linked there with at most two
+ * comparisons, otherwise it is added as with addToRBTree.
+ * @param tree: the tree to add an item to.
+ * @param data: item to add to the tree.
+ * @param hint: a node of the tree, or NULL.
+ * @return: 0 on failure, other on success. (if the item is already in the tree - failure).
+ */
+int addToRBTreeHint(RBTree *tree, void *data, Node *hint);
+
+/**
+ * add items given in ascending order to an empty tree, in O(n): the balanced tree is built
+ * directly, with no searches and no rotations, and every aggregate is computed once.
+ * @param tree: an empty tree.
+ * @param items: items to add, in strictly ascending order of the tree.
+ * @param n: number of items.
+ * @return: 0 on failure, other on success. (if the tree isn't empty or the items aren't strictly
+ * ascending - failure, and nothing is added).
+ */
+int addSortedToRBTree(RBTree *tree, void **items, int n);
+
 /**
  * check whether the tree contains this item.
  * @param tree: the tree to add an item to.
@@ -88,11 +226,49 @@ int containsRBTree(RBTree *tree, void *data); // implement it in RBTree.c
  */
 int forEachRBTree(RBTree *tree, forEachFunc func, void *args); // implement it in RBTree.c
 
+/**
+ * @param tree: an augmented tree.
+ * @return: the aggregate of the whole tree in O(1), NULL if the tree is empty or not augmented.
+ */
+const void *getRBTreeAggregate(const RBTree *tree);
+
+/**
+ * computes the aggregate of all the items x s.t low <= x <= high, in O(log n) calls to combineFunc.
+ * @param tree: an augmented tree.
+ * @param low: lower bound of the range (inclusive), compared with the tree CompareFunc.
+ * @param high: upper bound of the range (inclusive).
+ * @param out: aggregateSize bytes, will hold the aggregate of the range.
+ * @return: 0 if there are no items in range or on failure, other on success.
+ */
+int aggregateRangeRBTree(RBTree *tree, const void *low, const void *high, void *out);
+
+/**
+ * Activate a function on each item of an interval tree whose interval overlaps [low, high], in
+ * ascending order, in O(min(n, (k + 1) log n)) for k overlapping items: every node visited leads to
+ * an overlapping item within O(log n) steps. if one of the activations of the function returns 0,
+ * the process stops.
+ * @param tree: an interval tree.
+ * @param low: lower endpoint of the query interval.
+ * @param high: higher endpoint of the query interval.
+ * @param func: the function to activate on the overlapping items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachOverlapping(RBTree *tree, double low, double high, forEachFunc func, void *args);
+
 /**
  * free all memory of the data structure.
  * @param tree: the tree to free.
  */
 void freeRBTree(RBTree *tree); // implement it in RBTree.c
 
+/**
+ * free all memory of the data structure in a background thread, so the caller doesn't wait for
+ * freeFunc to run on every item. the tree must not be used after the call, and freeFunc must be
+ * safe to call from another thread. if no thread can be started the tree is freed right away.
+ * @param tree: the tree to free.
+ */
+void freeRBTreeDeferred(RBTree *tree);
+
 
 #endif //RBTREE_RBTREE_H
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "RadixTree.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MIN_CHILDREN_CAPACITY 4
+#define MAX_CHILDREN_CAPACITY 256 // one child per possible byte.
+
+/**
+ * constructor to a new RadixNode in the heap with the given label and no children.
+ * @param label - bytes of the label.
+ * @param labelLen - number of bytes in label.
+ * @return pointer to a new node in heap, NULL if fails.
+ */
+RadixNode *createRadixNode(const char *label, int labelLen)
+{
+    RadixNode *node = (RadixNode *) malloc(sizeof(RadixNode) + labelLen);
+    if (node == NULL)
+    {
+        return NULL;
+    }
+    node->children = NULL;
+    node->childBytes = NULL;
+    node->nChildren = 0;
+    node->capacity = 0;
+    node->isKey = 0;
+    node->labelLen = labelLen;
+    memcpy(node->label, label, labelLen);
+    return node;
+}
+
+RadixTree *newRadixTree()
+{
+    RadixTree *tree = (RadixTree *) malloc(sizeof(RadixTree));
+    if (tree == NULL)
+    {
+        return NULL;
+    }
+    tree->root = createRadixNode("", 0);
+    if (tree->root == NULL)
+    {
+        free(tree);
+        return NULL;
+    }
+    tree->size = 0;
+    tree->maxKeyLen = 0;
+    return tree;
+}
+
+/**
+ * finds the position of the child whose label starts with the given byte.
+ * @param node - a node.
+ * @param byte - first byte of the label.
+ * @param found - will be updated with 1 if there is such a child, 0 otherwise.
+ * @return the index of the child, or the index it should be inserted at if there is none.
+ */
+int findChildIndex(const RadixNode *node, unsigned char byte, int *found)
+{
+    int low = 0;
+    int high = node->nChildren;
+    while (low < high)
+    {
+        int mid = (low + high) / 2;
+        if (node->childBytes[mid] < byte)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    *found = (low < node->nChildren && node->childBytes[low] == byte);
+    return low;
+}
+
+/**
+ * makes room for one more child, doubling the children block when it's full.
+ * @param node - a node.
+ * @return 1 on success, 0 if memory allocation failed.
+ */
+int reserveChild(RadixNode *node)
+{
+    if (node->nChildren < node->capacity)
+    {
+        return 1;
+    }
+    int capacity = (node->capacity == 0) ? MIN_CHILDREN_CAPACITY : 2 * node->capacity;
+    if (capacity > MAX_CHILDREN_CAPACITY)
+    {
+        capacity = MAX_CHILDREN_CAPACITY;
+    }
+    // children pointers first, then their first bytes, in a single block.
+    RadixNode **children = (RadixNode **) malloc(capacity * (sizeof(RadixNode *) + 1));
+    if (children == NULL)
+    {
+        return 0;
+    }
+    unsigned char *childBytes = (unsigned char *) (children + capacity);
+    if (node->nChildren > 0)
+    {
+        memcpy(children, node->children, node->nChildren * sizeof(RadixNode *));
+        memcpy(childBytes, node->childBytes, node->nChildren);
+    }
+    free(node->children);
+    node->children = children;
+    node->childBytes = childBytes;
+    node->capacity = capacity;
+    return 1;
+}
+
+/**
+ * inserts a child at the given index of the sorted children.
+ * @param node - a node with room for the child (see reserveChild).
+ * @param index - index returned by findChildIndex.
+ * @param child - the child to insert.
+ */
+void insertChild(RadixNode *node, int index, RadixNode *child)
+{
+    int nAfter = node->nChildren - index;
+    memmove(node->children + index + 1, node->children + index, nAfter * sizeof(RadixNode *));
+    memmove(node->childBytes + index + 1, node->childBytes + index, nAfter);
+    node->children[index] = child;
+    node->childBytes[index] = (unsigned char) child->label[0];
+    node->nChildren++;
+}
+
+/**
+ * splits the label of a child, so its first commonLen bytes move to a new node between the child
+ * and its parent.
+ * @param parent - parent of the child.
+ * @param index - index of the child in parent.
+ * @param commonLen - number of label bytes to move to the new node, 0 < commonLen < labelLen.
+ * @return the new node, NULL if memory allocation failed.
+ */
+RadixNode *splitChild(RadixNode *parent, int index, int commonLen)
+{
+    RadixNode *child = parent->children[index];
+    RadixNode *middle = createRadixNode(child->label, commonLen);
+    if (middle == NULL || reserveChild(middle) == 0)
+    {
+        free(middle);
+        return NULL;
+    }
+    // the child label only shrinks, so it stays in its block.
+    child->labelLen -= commonLen;
+    memmove(child->label, child->label + commonLen, child->labelLen);
+    insertChild(middle, 0, child);
+    parent->children[index] = middle; // same first byte, the order is kept.
+    return middle;
+}
+
+int addToRadixTree(RadixTree *tree, const char *key)
+{
+    if (tree == NULL || key == NULL)
+    {
+        return 0;
+    }
+    int keyLen = (int) strlen(key);
+    RadixNode *node = tree->root;
+    int pos = 0;
+    while (pos < keyLen)
+    {
+        int found;
+        int index = findChildIndex(node, (unsigned char) key[pos], &found);
+        if (!found) // the rest of the key becomes a new leaf.
+        {
+            RadixNode *leaf = createRadixNode(key + pos, keyLen - pos);
+            if (leaf == NULL || reserveChild(node) == 0)
+            {
+                free(leaf);
+                return 0;
+            }
+            insertChild(node, index, leaf);
+            node = leaf;
+            break;
+        }
+        RadixNode *child = node->children[index];
+        int commonLen = 1;
+        while (commonLen < child->labelLen && pos + commonLen < keyLen &&
+               child->label[commonLen] == key[pos + commonLen])
+        {
+            commonLen++;
+        }
+        if (commonLen < child->labelLen)
+        {
+            child = splitChild(node, index, commonLen);
+            if (child == NULL)
+            {
+                return 0;
+            }
+        }
+        node = child;
+        pos += commonLen;
+    }
+    if (node->isKey)
+    {
+        return 0;
+    }
+    node->isKey = 1;
+    tree->size++;
+    if (keyLen > tree->maxKeyLen)
+    {
+        tree->maxKeyLen = keyLen;
+    }
+    return 1;
+}
+
+int containsRadixTree(RadixTree *tree, const char *key)
+{
+    if (tree == NULL || key == NULL)
+    {
+        return 0;
+    }
+    const RadixNode *node = tree->root;
+    while (*key != '\0')
+    {
+        int found;
+        int index = findChildIndex(node, (unsigned char) *key, &found);
+        if (!found)
+        {
+            return 0;
+        }
+        node = node->children[index];
+        if (strncmp(node->label, key, node->labelLen) != 0)
+        {
+            return 0;
+        }
+        key += node->labelLen;
+    }
+    return node->isKey;
+}
+
+/**
+ * recursively activates a function on the keys of a subtree, in ascending order.
+ * @param node - root of the subtree.
+ * @param buffer - holds the key of the node parent.
+ * @param len - length of the key of the node parent.
+ * @return 0 if one of the activations returned 0, 1 otherwise.
+ */
+int forEachRadixNode(const RadixNode *node, char *buffer, int len, forEachFunc func, void *args)
+{
+    memcpy(buffer + len, node->label, node->labelLen);
+    len += node->labelLen;
+    if (node->isKey)
+    {
+        buffer[len] = '\0';
+        if (func(buffer, args) == 0)
+        {
+            return 0;
+        }
+    }
+    for (int i = 0; i < node->nChildren; i++)
+    {
+        if (forEachRadixNode(node->children[i], buffer, len, func, args) == 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int forEachRadixTree(RadixTree *tree, forEachFunc func, void *args)
+{
+    if (tree == NULL || func == NULL)
+    {
+        return 0;
+    }
+    char *buffer = (char *) malloc(tree->maxKeyLen + 1);
+    if (buffer == NULL)
+    {
+        return 0;
+    }
+    int status = forEachRadixNode(tree->root, buffer, 0, func, args);
+    free(buffer);
+    return status;
+}
+
+/**
+ * recursively frees a subtree.
+ * @param node - root of the subtree.
+ */
+void freeRadixNodes(RadixNode *node)
+{
+    for (int i = 0; i < node->nChildren; i++)
+    {
+        freeRadixNodes(node->children[i]);
+    }
+    free(node->children);
+    free(node);
+}
+
+void freeRadixTree(RadixTree *tree)
+{
+    if (tree != NULL)
+    {
+        freeRadixNodes(tree->root);
+        free(tree);
+        tree = NULL;
+    }
+}
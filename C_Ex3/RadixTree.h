@@ -0,0 +1,72 @@
+#ifndef RBTREE_RADIXTREE_H
+#define RBTREE_RADIXTREE_H
+
+#include "RBTree.h"
+
+/*
+ * a node of a radix tree. the node stands for the key made of the labels on the way from the
+ * root, and the children are kept sorted by the first byte of their label.
+ */
+typedef struct RadixNode
+{
+	struct RadixNode **children;
+	unsigned char *childBytes; // first label byte of every child, in the same block as children.
+	int nChildren;
+	int capacity;
+	int isKey; // 1 if the key that ends at this node is in the set.
+	int labelLen;
+	char label[]; // the part of the key between the parent and this node (not '\0' terminated).
+} RadixNode;
+
+/**
+ * a set of strings stored as a compressed trie: keys that share a prefix share the nodes of that
+ * prefix, and a chain of nodes with a single child is merged into one node with a longer label.
+ */
+typedef struct RadixTree
+{
+	RadixNode *root;
+	int size;
+	int maxKeyLen;
+} RadixTree;
+
+/**
+ * constructs a new, empty, RadixTree.
+ * @return: the new tree, NULL on failure.
+ */
+RadixTree *newRadixTree();
+
+/**
+ * add a string to the set. the tree keeps its own copy of the string bytes it needs, the given
+ * string stays owned by the caller.
+ * @param tree: the tree to add the string to.
+ * @param key: string to add (assumes it ends with "\0").
+ * @return: 0 on failure, other on success. (if the string is already in the tree - failure).
+ */
+int addToRadixTree(RadixTree *tree, const char *key);
+
+/**
+ * check whether the set contains this string, in O(length of the string).
+ * @param tree: the tree to search.
+ * @param key: string to check.
+ * @return: 0 if the string is not in the tree, other if it is.
+ */
+int containsRadixTree(RadixTree *tree, const char *key);
+
+/**
+ * Activate a function on each string of the set, in the same ascending order as strcmp. the
+ * string passed to the function is rebuilt in a buffer that is only valid during the call. if one
+ * of the activations of the function returns 0, the process stops.
+ * @param tree: the tree with all the strings.
+ * @param func: the function to activate on all strings.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachRadixTree(RadixTree *tree, forEachFunc func, void *args);
+
+/**
+ * free all memory of the data structure.
+ * @param tree: the tree to free.
+ */
+void freeRadixTree(RadixTree *tree);
+
+#endif //RBTREE_RADIXTREE_H
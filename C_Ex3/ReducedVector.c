@@ -0,0 +1,209 @@
+#include "ReducedVector.h"
+#include "VectorKernels.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * missing comments for functions are in the header file.
+ */
+FloatVector *denseToFloatVector(const Vector *v)
+{
+    FloatVector *f = (FloatVector *) malloc(sizeof(FloatVector));
+    if (f == NULL)
+    {
+        return NULL;
+    }
+    // at least one float, so a copy always has a vector.
+    f->vector = (float *) malloc(((v->len > 0) ? v->len : 1) * sizeof(float));
+    if (f->vector == NULL)
+    {
+        free(f);
+        return NULL;
+    }
+    for (int i = 0; i < v->len; i++)
+    {
+        f->vector[i] = (float) v->vector[i];
+    }
+    f->len = v->len;
+    f->flags = 0;
+    f->sqrNorm = 0;
+    return f;
+}
+
+int floatVectorCompare1By1(const void *a, const void *b)
+{
+    const FloatVector *v1 = (const FloatVector *) a;
+    const FloatVector *v2 = (const FloatVector *) b;
+
+    int minLen = (v1->len <= v2->len) ? v1->len : v2->len;
+    int cmp = compareFloats(v1->vector, v2->vector, minLen);
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (v1->len > v2->len) - (v1->len < v2->len); // the shorter vector is smaller.
+}
+
+double calcFloatVectorSquaredNorm(FloatVector *v)
+{
+    if (v == NULL || v->vector == NULL)
+    {
+        return 0;
+    }
+    if (!(v->flags & VECTOR_NORM_CACHED))
+    {
+        v->sqrNorm = sumOfSquaresFloats(v->vector, v->len);
+        v->flags |= VECTOR_NORM_CACHED;
+    }
+    return v->sqrNorm;
+}
+
+int copyFloatIfNormIsLarger(const void *pVector, void *pMaxVector)
+{
+    if (pVector == NULL || pMaxVector == NULL)
+    {
+        return 0;
+    }
+    FloatVector *srcVector = (FloatVector *) pVector;
+    FloatVector *destVector = (FloatVector *) pMaxVector;
+
+    if (destVector->vector != NULL
+        && calcFloatVectorSquaredNorm(srcVector) <= calcFloatVectorSquaredNorm(destVector))
+    {
+        return 1; // the destination floats are kept, with no realloc.
+    }
+    float *coefficients = (float *) realloc(destVector->vector,
+                                            ((srcVector->len > 0) ? srcVector->len : 1) * sizeof(float));
+    if (coefficients == NULL)
+    {
+        return 0;
+    }
+    destVector->vector = coefficients;
+    destVector->len = srcVector->len;
+    memcpy(destVector->vector, srcVector->vector, srcVector->len * sizeof(float));
+    destVector->sqrNorm = calcFloatVectorSquaredNorm(srcVector);
+    destVector->flags = VECTOR_NORM_CACHED;
+    return 1;
+}
+
+void freeFloatVector(void *pVector)
+{
+    FloatVector *v = (FloatVector *) pVector;
+    if (v != NULL)
+    {
+        free(v->vector);
+        free(v);
+    }
+}
+
+QuantizedVector *denseToQuantizedVector(const Vector *v)
+{
+    QuantizedVector *q = (QuantizedVector *) malloc(sizeof(QuantizedVector));
+    if (q == NULL)
+    {
+        return NULL;
+    }
+    q->vector = (int8_t *) malloc((v->len > 0) ? v->len : 1);
+    if (q->vector == NULL)
+    {
+        free(q);
+        return NULL;
+    }
+    double maxAbs = 0;
+    for (int i = 0; i < v->len; i++)
+    {
+        double absValue = (v->vector[i] < 0) ? -v->vector[i] : v->vector[i];
+        maxAbs = (absValue > maxAbs) ? absValue : maxAbs;
+    }
+    q->scale = maxAbs / QUANTIZED_MAX;
+    for (int i = 0; i < v->len; i++)
+    {
+        double scaled = (q->scale > 0) ? v->vector[i] / q->scale : 0;
+        int rounded = (int) (scaled + ((scaled < 0) ? -0.5 : 0.5)); // |scaled| <= QUANTIZED_MAX.
+        q->vector[i] = (int8_t) rounded;
+    }
+    q->len = v->len;
+    q->flags = 0;
+    q->sqrNorm = 0;
+    return q;
+}
+
+int quantizedVectorCompare1By1(const void *a, const void *b)
+{
+    const QuantizedVector *v1 = (const QuantizedVector *) a;
+    const QuantizedVector *v2 = (const QuantizedVector *) b;
+
+    int minLen = (v1->len <= v2->len) ? v1->len : v2->len;
+    int cmp = 0;
+    if (v1->scale == v2->scale && v1->scale > 0)
+    {
+        cmp = compareInt8(v1->vector, v2->vector, minLen);
+    }
+    else
+    {
+        for (int i = 0; i < minLen && cmp == 0; i++)
+        {
+            double x = v1->vector[i] * v1->scale;
+            double y = v2->vector[i] * v2->scale;
+            cmp = (x > y) - (x < y);
+        }
+    }
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+    return (v1->len > v2->len) - (v1->len < v2->len); // the shorter vector is smaller.
+}
+
+double calcQuantizedVectorSquaredNorm(QuantizedVector *v)
+{
+    if (v == NULL || v->vector == NULL)
+    {
+        return 0;
+    }
+    if (!(v->flags & VECTOR_NORM_CACHED))
+    {
+        v->sqrNorm = (double) sumOfSquaresInt8(v->vector, v->len) * v->scale * v->scale;
+        v->flags |= VECTOR_NORM_CACHED;
+    }
+    return v->sqrNorm;
+}
+
+int copyQuantizedIfNormIsLarger(const void *pVector, void *pMaxVector)
+{
+    if (pVector == NULL || pMaxVector == NULL)
+    {
+        return 0;
+    }
+    QuantizedVector *srcVector = (QuantizedVector *) pVector;
+    QuantizedVector *destVector = (QuantizedVector *) pMaxVector;
+
+    if (destVector->vector != NULL
+        && calcQuantizedVectorSquaredNorm(srcVector) <= calcQuantizedVectorSquaredNorm(destVector))
+    {
+        return 1; // the destination bytes are kept, and so is their scale.
+    }
+    int8_t *coefficients = (int8_t *) realloc(destVector->vector,
+                                              (srcVector->len > 0) ? srcVector->len : 1);
+    if (coefficients == NULL)
+    {
+        return 0;
+    }
+    destVector->vector = coefficients;
+    destVector->len = srcVector->len;
+    destVector->scale = srcVector->scale;
+    memcpy(destVector->vector, srcVector->vector, srcVector->len);
+    destVector->sqrNorm = calcQuantizedVectorSquaredNorm(srcVector);
+    destVector->flags = VECTOR_NORM_CACHED;
+    return 1;
+}
+
+void freeQuantizedVector(void *pVector)
+{
+    QuantizedVector *v = (QuantizedVector *) pVector;
+    if (v != NULL)
+    {
+        free(v->vector);
+        free(v);
+    }
+}
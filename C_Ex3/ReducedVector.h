@@ -0,0 +1,106 @@
+#ifndef TA_EX3_REDUCEDVECTOR_H
+#define TA_EX3_REDUCEDVECTOR_H
+
+#include "Structs.h"
+#include <stdint.h>
+
+#define QUANTIZED_MAX 127 // largest absolute value of a quantized coefficient.
+
+/**
+ * Represents a vector with float coefficients, half the memory of a Vector. The float* should
+ * be dynamically allocated.
+ */
+typedef struct FloatVector
+{
+	int len;
+	float *vector;
+	int flags; // VECTOR_* flags.
+	double sqrNorm; // cached squared norm, valid iff flags & VECTOR_NORM_CACHED.
+} FloatVector;
+
+/**
+ * Represents a vector with int8 coefficients and a scale, an eighth of the memory of a Vector:
+ * coefficient i is vector[i] * scale. The int8_t* should be dynamically allocated.
+ */
+typedef struct QuantizedVector
+{
+	int len;
+	int8_t *vector;
+	double scale; // >= 0.
+	int flags; // VECTOR_* flags.
+	double sqrNorm; // cached squared norm, valid iff flags & VECTOR_NORM_CACHED.
+} QuantizedVector;
+
+/**
+ * @param v - a dense vector.
+ * @return a new FloatVector in the heap with the coefficients of v rounded to floats, NULL on
+ * failure.
+ */
+FloatVector *denseToFloatVector(const Vector *v);
+
+/**
+ * CompFunc for FloatVectors, same order as vectorCompare1By1.
+ * @param a - first vector
+ * @param b - second vector
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+int floatVectorCompare1By1(const void *a, const void *b);
+
+/**
+ * @param v - the vector.
+ * @return the squared L2 norm of v accumulated in doubles, computed on the first call and cached
+ * in v.
+ */
+double calcFloatVectorSquaredNorm(FloatVector *v);
+
+/**
+ * copyIfNormIsLarger for FloatVectors.
+ * @param pVector pointer to FloatVector
+ * @param pMaxVector pointer to FloatVector, with a NULL vector if nothing was copied to it yet.
+ * @return 1 on success, 0 on failure (if pVector == NULL: failure).
+ */
+int copyFloatIfNormIsLarger(const void *pVector, void *pMaxVector);
+
+/**
+ * FreeFunc for FloatVectors
+ */
+void freeFloatVector(void *pVector);
+
+/**
+ * quantizes a vector: the scale is the largest absolute coefficient / QUANTIZED_MAX, and every
+ * coefficient is rounded to the nearest multiple of the scale.
+ * @param v - a dense vector.
+ * @return a new QuantizedVector in the heap, NULL on failure.
+ */
+QuantizedVector *denseToQuantizedVector(const Vector *v);
+
+/**
+ * CompFunc for QuantizedVectors, same order as vectorCompare1By1 on the coefficients they stand
+ * for. vectors with the same scale are compared by their bytes.
+ * @param a - first vector
+ * @param b - second vector
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+int quantizedVectorCompare1By1(const void *a, const void *b);
+
+/**
+ * @param v - the vector.
+ * @return the squared L2 norm of v, the squares of the bytes are summed exactly in integers.
+ * computed on the first call and cached in v.
+ */
+double calcQuantizedVectorSquaredNorm(QuantizedVector *v);
+
+/**
+ * copyIfNormIsLarger for QuantizedVectors.
+ * @param pVector pointer to QuantizedVector
+ * @param pMaxVector pointer to QuantizedVector, with a NULL vector if nothing was copied to it yet.
+ * @return 1 on success, 0 on failure (if pVector == NULL: failure).
+ */
+int copyQuantizedIfNormIsLarger(const void *pVector, void *pMaxVector);
+
+/**
+ * FreeFunc for QuantizedVectors
+ */
+void freeQuantizedVector(void *pVector);
+
+#endif //TA_EX3_REDUCEDVECTOR_H
@@ -0,0 +1,271 @@
+#define _POSIX_C_SOURCE 200809L // for mmap, ftruncate and mkstemp with -std=c99
+#include "SharedRBTree.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHARED_TREE_MAGIC 0x3130454552544253ULL // "SBTREE01"
+#define SHARED_ALIGNMENT 8 // every node and item starts on a double boundary.
+#define ALIGN_UP(N) (((N) + SHARED_ALIGNMENT - 1) & ~((size_t) SHARED_ALIGNMENT - 1))
+#define NODE_AT(TREE, OFFSET) ((const SharedNode *) ((TREE)->base + (OFFSET)))
+#define NO_NODE 0
+#define TEMP_SUFFIX ".XXXXXX" // mkstemp template of the file an export is written to.
+
+/**
+ * the start of every exported region.
+ */
+typedef struct SharedRegionHeader
+{
+    uint64_t magic;
+    uint64_t regionSize;
+    uint64_t root;
+    uint64_t size;
+} SharedRegionHeader;
+
+/**
+ * creates a temporary file of the given size next to path and maps it for writing. the tree is
+ * written there and renamed over path when it's complete, so processes that mapped an older
+ * export keep it intact, and no process ever opens a half written region.
+ * @param path - the file the region will be renamed to.
+ * @param regionSize - size of the file.
+ * @param tmpPath - will hold the name of the temporary file, to be freed by the caller.
+ * @return the mapped region, NULL on failure (the temporary file is removed).
+ */
+char *createRegion(const char *path, size_t regionSize, char **tmpPath)
+{
+    *tmpPath = (char *) malloc(strlen(path) + sizeof(TEMP_SUFFIX));
+    if (*tmpPath == NULL)
+    {
+        return NULL;
+    }
+    strcpy(*tmpPath, path);
+    strcat(*tmpPath, TEMP_SUFFIX);
+    int fd = mkstemp(*tmpPath);
+    if (fd < 0)
+    {
+        free(*tmpPath);
+        *tmpPath = NULL;
+        return NULL;
+    }
+    char *base = NULL;
+    if (fchmod(fd, 0644) == 0 && ftruncate(fd, (off_t) regionSize) == 0)
+    {
+        base = mmap(NULL, regionSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == NULL || base == MAP_FAILED)
+    {
+        unlink(*tmpPath);
+        free(*tmpPath);
+        *tmpPath = NULL;
+        return NULL;
+    }
+    return base;
+}
+
+int exportRBTree(const RBTree *tree, const char *path, SerializeFunc serializeFunc)
+{
+    if (tree == NULL || path == NULL || serializeFunc == NULL)
+    {
+        return 0;
+    }
+    size_t count = 0;
+    const Node **order = (const Node **) malloc(sizeof(Node *) * (tree->size + 1));
+    if (order == NULL)
+    {
+        return 0;
+    }
+    // breadth first order, the array is its own queue.
+    if (tree->root != NULL)
+    {
+        order[count++] = tree->root;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (order[i]->left != NULL)
+        {
+            order[count++] = order[i]->left;
+        }
+        if (order[i]->right != NULL)
+        {
+            order[count++] = order[i]->right;
+        }
+    }
+
+    size_t nodesOffset = ALIGN_UP(sizeof(SharedRegionHeader));
+    size_t dataOffset = nodesOffset + count * sizeof(SharedNode);
+    size_t regionSize = dataOffset;
+    for (size_t i = 0; i < count; i++)
+    {
+        regionSize += ALIGN_UP(serializeFunc(order[i]->data, NULL));
+    }
+    char *tmpPath;
+    char *base = createRegion(path, regionSize, &tmpPath);
+    if (base == NULL)
+    {
+        free(order);
+        return 0;
+    }
+
+    SharedRegionHeader *header = (SharedRegionHeader *) base;
+    header->regionSize = regionSize;
+    header->root = (count > 0) ? nodesOffset : NO_NODE;
+    header->size = count;
+
+    // in breadth first order the children of the i'th node are the next unassigned indices.
+    SharedNode *nodes = (SharedNode *) (base + nodesOffset);
+    size_t nextChild = 1;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t offset = nodesOffset + i * sizeof(SharedNode);
+        SharedNode *node = &nodes[i];
+        node->color = order[i]->color;
+        node->left = node->right = NO_NODE;
+        if (order[i]->left != NULL)
+        {
+            node->left = nodesOffset + nextChild * sizeof(SharedNode);
+            nodes[nextChild++].parent = offset;
+        }
+        if (order[i]->right != NULL)
+        {
+            node->right = nodesOffset + nextChild * sizeof(SharedNode);
+            nodes[nextChild++].parent = offset;
+        }
+        node->data = dataOffset;
+        dataOffset += ALIGN_UP(serializeFunc(order[i]->data, base + dataOffset));
+    }
+    if (count > 0) // the region of an empty tree ends right after its header.
+    {
+        nodes[0].parent = NO_NODE;
+    }
+    free(order);
+    header->magic = SHARED_TREE_MAGIC; // the region is valid only once everything is written.
+    int status = (munmap(base, regionSize) == 0 && rename(tmpPath, path) == 0);
+    if (!status)
+    {
+        unlink(tmpPath);
+    }
+    free(tmpPath);
+    return status;
+}
+
+SharedRBTree *attachSharedRBTree(const char *path, CompareFunc compFunc)
+{
+    if (path == NULL || compFunc == NULL)
+    {
+        return NULL;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat st;
+    void *base = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t) st.st_size >= sizeof(SharedRegionHeader))
+    {
+        base = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // the mapping stays valid.
+    if (base == MAP_FAILED)
+    {
+        return NULL;
+    }
+    const SharedRegionHeader *header = (const SharedRegionHeader *) base;
+    SharedRBTree *tree = NULL;
+    if (header->magic == SHARED_TREE_MAGIC && header->regionSize == (uint64_t) st.st_size &&
+        header->root < header->regionSize)
+    {
+        tree = (SharedRBTree *) malloc(sizeof(SharedRBTree));
+    }
+    if (tree == NULL)
+    {
+        munmap(base, (size_t) st.st_size);
+        return NULL;
+    }
+    tree->base = (const char *) base;
+    tree->regionSize = (size_t) st.st_size;
+    tree->root = header->root;
+    tree->compFunc = compFunc;
+    tree->size = (int) header->size;
+    return tree;
+}
+
+int containsSharedRBTree(const SharedRBTree *tree, const void *data)
+{
+    uint64_t p = tree->root;
+    while (p != NO_NODE)
+    {
+        const SharedNode *node = NODE_AT(tree, p);
+        int cmp = tree->compFunc(tree->base + node->data, data);
+        if (cmp == 0)
+        {
+            return 1;
+        }
+        p = (cmp > 0) ? node->left : node->right;
+    }
+    return 0;
+}
+
+/**
+ * gets an offset of a node that represent a subtree root and returns the minimal node in it.
+ * @param tree - the shared tree.
+ * @param root - offset of a node.
+ * @return offset of the minimal node in the subtree.
+ */
+uint64_t getSharedSubTreeMin(const SharedRBTree *tree, uint64_t root)
+{
+    while (root != NO_NODE && NODE_AT(tree, root)->left != NO_NODE)
+    {
+        root = NODE_AT(tree, root)->left;
+    }
+    return root;
+}
+
+/**
+ * gets an offset of a node and returns the offset of it's successor in the tree.
+ * @param tree - the shared tree.
+ * @param node - offset of a node.
+ * @return offset of the successor, NO_NODE if it's the maximal node.
+ */
+uint64_t getSharedSuccessor(const SharedRBTree *tree, uint64_t node)
+{
+    if (NODE_AT(tree, node)->right != NO_NODE)
+    {
+        return getSharedSubTreeMin(tree, NODE_AT(tree, node)->right);
+    }
+    uint64_t parent = NODE_AT(tree, node)->parent;
+    while (parent != NO_NODE && node == NODE_AT(tree, parent)->right)
+    {
+        node = parent;
+        parent = NODE_AT(tree, node)->parent;
+    }
+    return parent;
+}
+
+int forEachSharedRBTree(const SharedRBTree *tree, forEachFunc func, void *args)
+{
+    uint64_t p = getSharedSubTreeMin(tree, tree->root);
+    while (p != NO_NODE)
+    {
+        if (func(tree->base + NODE_AT(tree, p)->data, args) == 0)
+        {
+            return 0;
+        }
+        p = getSharedSuccessor(tree, p);
+    }
+    return 1;
+}
+
+void detachSharedRBTree(SharedRBTree *tree)
+{
+    if (tree != NULL)
+    {
+        munmap((void *) tree->base, tree->regionSize);
+        free(tree);
+    }
+}
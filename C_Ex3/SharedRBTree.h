@@ -0,0 +1,84 @@
+#ifndef RBTREE_SHAREDRBTREE_H
+#define RBTREE_SHAREDRBTREE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "RBTree.h"
+
+/**
+ * a function to copy an item of the tree into a flat, position independent block of bytes
+ * (e.g. a string with its '\0', or a vector length followed by its coefficients).
+ * @data: a pointer to an item of the tree.
+ * @buffer: where to write the item, NULL to only ask for its size.
+ * @return: the number of bytes the item takes.
+ */
+typedef size_t (*SerializeFunc)(const void *data, void *buffer);
+
+/**
+ * a node of a shared tree. links are offsets from the start of the region rather than pointers,
+ * so the region can be mapped at any address. offset 0 (the region header) stands for NULL.
+ */
+typedef struct SharedNode
+{
+	uint64_t parent, left, right;
+	uint64_t data; // offset of the serialized item.
+	uint64_t color;
+} SharedNode;
+
+/**
+ * a read only view of a tree exported to a shared region.
+ */
+typedef struct SharedRBTree
+{
+	const char *base; // start of the mapped region.
+	size_t regionSize;
+	uint64_t root;
+	CompareFunc compFunc;
+	int size;
+} SharedRBTree;
+
+/**
+ * lays a tree out in a new file that other processes can map, e.g. under /dev/shm.
+ * the tree keeps the shape and colors RBTree.c built, nodes are written level by level so the
+ * top of the tree shares the first pages of the region.
+ * @param tree: the tree to export.
+ * @param path: the file to create. an existing file is replaced by a rename once the new region is
+ * complete, so processes attached to it keep reading the old tree.
+ * @param serializeFunc: writes an item as flat bytes, those bytes are what readers compare.
+ * @return: 0 on failure, other on success.
+ */
+int exportRBTree(const RBTree *tree, const char *path, SerializeFunc serializeFunc);
+
+/**
+ * maps an exported tree read only, without copying it.
+ * @param path: a file written by exportRBTree.
+ * @param compFunc: compares two serialized items.
+ * @return: the tree view, NULL on failure.
+ */
+SharedRBTree *attachSharedRBTree(const char *path, CompareFunc compFunc);
+
+/**
+ * check whether the shared tree contains this item.
+ * @param tree: the tree to search.
+ * @param data: item to check, in its serialized form.
+ * @return: 0 if the item is not in the tree, other if it is.
+ */
+int containsSharedRBTree(const SharedRBTree *tree, const void *data);
+
+/**
+ * Activate a function on each (serialized) item of the shared tree, in an ascending order. if one
+ * of the activations of the function returns 0, the process stops.
+ * @param tree: the tree with all the items.
+ * @param func: the function to activate on all items.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachSharedRBTree(const SharedRBTree *tree, forEachFunc func, void *args);
+
+/**
+ * unmaps the shared tree and frees the view, the exported file itself is left in place.
+ * @param tree: the tree to detach.
+ */
+void detachSharedRBTree(SharedRBTree *tree);
+
+#endif //RBTREE_SHAREDRBTREE_H
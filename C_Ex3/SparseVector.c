@@ -0,0 +1,162 @@
+#include "SparseVector.h"
+#include "VectorKernels.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * (re)allocates the single block of the values and indices of a vector.
+ * @param v - the vector, its values are NULL or a block from a previous call.
+ * @param nnz - number of coefficients to make room for.
+ * @return 0 on failure (v is unchanged), other on success.
+ */
+int allocSparseCoefficients(SparseVector *v, int nnz)
+{
+    // at least one slot, so a vector with coefficients never has NULL values.
+    size_t slots = (nnz > 0) ? (size_t) nnz : 1;
+    double *block = (double *) realloc(v->values, slots * (sizeof(double) + sizeof(int)));
+    if (block == NULL)
+    {
+        return 0;
+    }
+    v->values = block;
+    v->indices = (int *) (block + slots);
+    return 1;
+}
+
+SparseVector *newSparseVector(int len, int nnz)
+{
+    SparseVector *v = (SparseVector *) malloc(sizeof(SparseVector));
+    if (v == NULL)
+    {
+        return NULL;
+    }
+    v->len = len;
+    v->nnz = nnz;
+    v->values = NULL;
+    v->indices = NULL;
+    v->flags = 0;
+    v->sqrNorm = 0;
+    if (nnz > 0 && allocSparseCoefficients(v, nnz) == 0)
+    {
+        free(v);
+        return NULL;
+    }
+    return v;
+}
+
+SparseVector *denseToSparseVector(const Vector *v)
+{
+    int nnz = 0;
+    for (int i = 0; i < v->len; i++)
+    {
+        nnz += (v->vector[i] != 0);
+    }
+    SparseVector *sparse = newSparseVector(v->len, nnz);
+    if (sparse == NULL)
+    {
+        return NULL;
+    }
+    int next = 0;
+    for (int i = 0; i < v->len; i++)
+    {
+        if (v->vector[i] != 0)
+        {
+            sparse->values[next] = v->vector[i];
+            sparse->indices[next] = i;
+            next++;
+        }
+    }
+    return sparse;
+}
+
+int sparseVectorCompare1By1(const void *a, const void *b)
+{
+    const SparseVector *v1 = (const SparseVector *) a;
+    const SparseVector *v2 = (const SparseVector *) b;
+    int minLen = (v1->len <= v2->len) ? v1->len : v2->len;
+
+    // the coefficients between the merged indices are zeros in both vectors.
+    int i = 0, j = 0;
+    while (i < v1->nnz || j < v2->nnz)
+    {
+        int index1 = (i < v1->nnz) ? v1->indices[i] : minLen;
+        int index2 = (j < v2->nnz) ? v2->indices[j] : minLen;
+        int index = (index1 <= index2) ? index1 : index2;
+        if (index >= minLen)
+        {
+            break;
+        }
+        double x = (index1 == index) ? v1->values[i++] : 0;
+        double y = (index2 == index) ? v2->values[j++] : 0;
+        if (x < y)
+        {
+            return -1;
+        }
+        if (x > y)
+        {
+            return 1;
+        }
+    }
+    return (v1->len > v2->len) - (v1->len < v2->len); // the shorter vector is smaller.
+}
+
+void invalidateSparseVectorNorm(SparseVector *v)
+{
+    v->flags &= ~VECTOR_NORM_CACHED;
+}
+
+double calcSparseVectorSquaredNorm(SparseVector *v)
+{
+    if (v == NULL || v->values == NULL)
+    {
+        return 0;
+    }
+    if (!(v->flags & VECTOR_NORM_CACHED))
+    {
+        v->sqrNorm = sumOfSquares(v->values, v->nnz);
+        v->flags |= VECTOR_NORM_CACHED;
+    }
+    return v->sqrNorm;
+}
+
+int copySparseIfNormIsLarger(const void *pVector, void *pMaxVector)
+{
+    if (pVector == NULL || pMaxVector == NULL)
+    {
+        return 0;
+    }
+    SparseVector *srcVector = (SparseVector *) pVector;
+    SparseVector *destVector = (SparseVector *) pMaxVector;
+
+    if (destVector->values != NULL)
+    {
+        if (calcSparseVectorSquaredNorm(srcVector) <= calcSparseVectorSquaredNorm(destVector))
+        {
+            return 1; // the destination keeps its values and indices.
+        }
+    }
+    if (allocSparseCoefficients(destVector, srcVector->nnz) == 0)
+    {
+        return 0;
+    }
+    destVector->len = srcVector->len;
+    destVector->nnz = srcVector->nnz;
+    if (srcVector->nnz > 0)
+    {
+        memcpy(destVector->values, srcVector->values, srcVector->nnz * sizeof(double));
+        memcpy(destVector->indices, srcVector->indices, srcVector->nnz * sizeof(int));
+    }
+    destVector->sqrNorm = calcSparseVectorSquaredNorm(srcVector);
+    destVector->flags = VECTOR_NORM_CACHED;
+    return 1;
+}
+
+void freeSparseVector(void *pVector)
+{
+    SparseVector *v = (SparseVector *) pVector;
+    if (v != NULL)
+    {
+        free(v->values);
+        free(v);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef TA_EX3_SPARSEVECTOR_H
+#define TA_EX3_SPARSEVECTOR_H
+
+#include "Structs.h"
+
+/**
+ * Represents a vector of len coefficients that are mostly zeros: only the nnz nonzero
+ * coefficients are kept, as values[i] at index indices[i], sorted by index. values and indices
+ * share a single allocation starting at values.
+ */
+typedef struct SparseVector
+{
+	int len;
+	int nnz;
+	double *values;
+	int *indices;
+	int flags; // VECTOR_* flags.
+	double sqrNorm; // cached squared norm, valid iff flags & VECTOR_NORM_CACHED.
+} SparseVector;
+
+/**
+ * constructs a new SparseVector in the heap with room for nnz coefficients, to be filled by the
+ * caller in increasing index order. a vector with nnz == 0 gets no coefficients (values == NULL)
+ * and can be used as the destination of copySparseIfNormIsLarger.
+ * @param len - number of coefficients (zeros included).
+ * @param nnz - number of coefficients to keep.
+ * @return the new vector, NULL on failure.
+ */
+SparseVector *newSparseVector(int len, int nnz);
+
+/**
+ * @param v - a dense vector.
+ * @return a new SparseVector in the heap with the nonzero coefficients of v, NULL on failure.
+ */
+SparseVector *denseToSparseVector(const Vector *v);
+
+/**
+ * CompFunc for SparseVectors, orders them as vectorCompare1By1 orders the dense vectors with the
+ * same coefficients. the index lists are merged, so it runs in O(nnz) rather than O(len).
+ * @param a - first vector
+ * @param b - second vector
+ * @return equal to 0 iff a == b. lower than 0 if a < b. Greater than 0 iff b < a.
+ */
+int sparseVectorCompare1By1(const void *a, const void *b);
+
+/**
+ * drops the cached norm of a vector, call it after changing its coefficients.
+ * @param v - the vector.
+ */
+void invalidateSparseVectorNorm(SparseVector *v);
+
+/**
+ * @param v - the vector.
+ * @return the squared L2 norm of v, computed on the first call and cached in v.
+ */
+double calcSparseVectorSquaredNorm(SparseVector *v);
+
+/**
+ * copyIfNormIsLarger for SparseVectors, copies pVector to pMaxVector if its norm is larger or if
+ * pMaxVector has no coefficients yet.
+ * @param pVector pointer to SparseVector
+ * @param pMaxVector pointer to SparseVector
+ * @return 1 on success, 0 on failure (if pVector == NULL: failure).
+ */
+int copySparseIfNormIsLarger(const void *pVector, void *pMaxVector);
+
+/**
+ * FreeFunc for SparseVectors
+ */
+void freeSparseVector(void *pVector);
+
+#endif //TA_EX3_SPARSEVECTOR_H
@@ -1,7 +1,71 @@
+#define _POSIX_C_SOURCE 200809L // for writev with -std=c99
 #include "Structs.h"
+#include "VectorKernels.h"
 #include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <pthread.h>
 #include "string.h"
 
+#define WRITE_BATCH_SIZE 512 // iovecs per writev call, below the IOV_MAX of any POSIX system.
+#define FINGERPRINT_MULTIPLIER 0x9E3779B97F4A7C15ULL // 2^64 / golden ratio, spreads the bits.
+
+/**
+ * state of a join: where the next word goes, and what follows every word.
+ */
+typedef struct StringJoin
+{
+    char *end;
+    const char *separator;
+    size_t separatorLen;
+    size_t totalLen;
+} StringJoin;
+
+/**
+ * state of a write: the words gathered for the next writev call.
+ */
+typedef struct StringWrite
+{
+    struct iovec batch[WRITE_BATCH_SIZE];
+    int count;
+    int fd;
+    const char *separator;
+    size_t separatorLen;
+} StringWrite;
+
+/**
+ * a vector in a top k heap, rank is its position in the tree order (for breaking ties).
+ */
+typedef struct NormHeapEntry
+{
+    const Vector *vector;
+    double sqrNorm;
+    size_t rank;
+} NormHeapEntry;
+
+/**
+ * bounded min heap of the largest norm vectors seen so far, the worst of them on top.
+ */
+typedef struct NormHeap
+{
+    NormHeapEntry *entries;
+    int size;
+    int capacity;
+    size_t nextRank;
+} NormHeap;
+
+/**
+ * a part of the tree order scanned by a single thread of findTopKNormVectorsParallel.
+ */
+typedef struct TopKTask
+{
+    Vector *const *vectors;
+    size_t first;
+    size_t count;
+    NormHeap heap;
+} TopKTask;
+
 /**
  * missing comments for functions are in the header file.
  */
@@ -10,41 +74,123 @@ int vectorCompare1By1(const void *a, const void *b)
     Vector *v1 = (Vector *) a;
     Vector *v2 = (Vector *) b;
 
-    int minLen = (v1->len >= v2->len) ? v1->len : v2->len;
-    for (int i = 0; i < minLen; i++)
+    int minLen = (v1->len <= v2->len) ? v1->len : v2->len;
+    int cmp = compareDoubles(v1->vector, v2->vector, minLen);
+    if (cmp != 0)
     {
-        if (v1->vector[i] > v2->vector[i])
-        {
-            return 1;
-        }
-        else if (v1->vector[i] < v2->vector[i])
-        {
-            return -1;
-        }
-        else
-        {
-            continue;
-        }
+        return cmp;
     }
-    return v1->len > v2->len;
+    return (v1->len > v2->len) - (v1->len < v2->len); // the shorter vector is smaller.
+}
+
+void initVector(Vector *v, double *coefficients, int len)
+{
+    v->len = len;
+    v->vector = coefficients;
+    v->flags = 0;
+    v->sqrNorm = 0;
+    v->fingerprint = 0;
+}
+
+void invalidateVectorCache(Vector *v)
+{
+    v->flags &= ~(VECTOR_NORM_CACHED | VECTOR_FINGERPRINT_CACHED);
+}
+
+double calcVectorSquaredNorm(const Vector *v)
+{
+    if (v == NULL || v->vector == NULL)
+    {
+        return 0;
+    }
+    return sumOfSquares(v->vector, v->len);
+}
+
+double getCachedVectorSquaredNorm(Vector *v)
+{
+    if (v == NULL || v->vector == NULL)
+    {
+        return 0;
+    }
+    if (!(v->flags & VECTOR_NORM_CACHED))
+    {
+        v->sqrNorm = sumOfSquares(v->vector, v->len);
+        v->flags |= VECTOR_NORM_CACHED;
+    }
+    return v->sqrNorm;
 }
 
 /**
- * calculates the norm of a given vector.
- * @return norm.
+ * mixes the bits of a word so that every input bit affects every output bit (splitmix64 final).
  */
-double calcVectorSquaredNorm(Vector *v)
+uint64_t mixFingerprint(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x;
+}
+
+uint64_t getVectorFingerprint(Vector *v)
 {
-    if (v != NULL && v->vector != NULL)
+    if (!(v->flags & VECTOR_FINGERPRINT_CACHED))
+    {
+        uint64_t hash = (uint64_t) v->len;
+        for (int i = 0; i < v->len; i++)
+        {
+            double coefficient = (v->vector[i] == 0) ? 0 : v->vector[i]; // -0.0 == 0.0.
+            uint64_t bits;
+            memcpy(&bits, &coefficient, sizeof(bits));
+            hash = (hash ^ bits) * FINGERPRINT_MULTIPLIER;
+            hash ^= hash >> 32;
+        }
+        v->fingerprint = mixFingerprint(hash);
+        v->flags |= VECTOR_FINGERPRINT_CACHED;
+    }
+    return v->fingerprint;
+}
+
+int vectorsEqual(const void *a, const void *b)
+{
+    Vector *v1 = (Vector *) a;
+    Vector *v2 = (Vector *) b;
+    if (v1->len != v2->len || getVectorFingerprint(v1) != getVectorFingerprint(v2))
+    {
+        return 0;
+    }
+    return vectorCompare1By1(v1, v2) == 0;
+}
+
+int dedupVectors(Vector **vectors, int n)
+{
+    size_t capacity = 1;
+    while (capacity < 2 * (size_t) n) // at most half full, so the probe sequences stay short.
+    {
+        capacity <<= 1;
+    }
+    Vector **table = (Vector **) calloc(capacity, sizeof(Vector *));
+    if (table == NULL)
     {
-        double sqrNorm = 0;
-        for (int i = 0; i < v->len; ++i)
+        return -1;
+    }
+    int unique = 0;
+    for (int i = 0; i < n; i++)
+    {
+        size_t slot = (size_t) getVectorFingerprint(vectors[i]) & (capacity - 1);
+        while (table[slot] != NULL && !vectorsEqual(table[slot], vectors[i]))
         {
-            sqrNorm += (v->vector[i] * v->vector[i]);
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == NULL) // first appearance.
+        {
+            table[slot] = vectors[i];
+            vectors[unique++] = vectors[i];
         }
-        return sqrNorm;
     }
-    return 0;
+    free(table);
+    return unique;
 }
 
 int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
@@ -55,13 +201,19 @@ int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
     }
     Vector *srcVector = (Vector *) pVector;
     Vector *destVector = (Vector *) pMaxVector;
+    // neither vector has to be set up with initVector, so neither cache is trusted.
+    double srcNorm = calcVectorSquaredNorm(srcVector);
 
     if (destVector->vector == NULL)
     {
-        destVector->vector = (double *) malloc(sizeof(double) * srcVector->len);
-        if (destVector->vector == NULL)
+        // a vector with no coefficients is copied without any, malloc(0) may return NULL.
+        if (srcVector->len > 0)
         {
-            return 0;
+            destVector->vector = (double *) malloc(sizeof(double) * srcVector->len);
+            if (destVector->vector == NULL)
+            {
+                return 0;
+            }
         }
     }
     else //dest->vector != NULL
@@ -70,9 +222,7 @@ int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
         {
             return 0;
         }
-        double srcNorm = calcVectorSquaredNorm(srcVector);
-        double destNorm = calcVectorSquaredNorm(destVector);
-        if (srcNorm > destNorm)
+        if (srcNorm > calcVectorSquaredNorm(destVector))
         {
             destVector->vector = realloc(destVector->vector, sizeof(double) * srcVector->len);
             if (destVector->vector == NULL)
@@ -80,13 +230,37 @@ int copyIfNormIsLarger(const void *pVector, void *pMaxVector)
                 return 0;
             }
         }
-        else // srcNorm <= destNorm
+        else // srcNorm <= destNorm, the destination is already the max so far.
         {
-            return 0;
+            return 1;
         }
     }
     destVector->len = srcVector->len;
-    memcpy(destVector->vector, srcVector->vector, srcVector->len * sizeof(double));
+    if (srcVector->len > 0)
+    {
+        memcpy(destVector->vector, srcVector->vector, srcVector->len * sizeof(double));
+    }
+    destVector->sqrNorm = srcNorm;
+    destVector->flags = VECTOR_NORM_CACHED;
+    return 1;
+}
+
+/**
+ * ForEach function that remembers pVector if its norm is larger than the largest norm so far.
+ * the norm is computed, since the vectors of the tree don't have to be set up with initVector.
+ * @param pVector - Vector*
+ * @param pMax - MaxNormAggregate* with the largest norm vector so far (or a NULL vector).
+ * @return 1
+ */
+int trackMaxNorm(const void *pVector, void *pMax)
+{
+    MaxNormAggregate *max = (MaxNormAggregate *) pMax;
+    double sqrNorm = calcVectorSquaredNorm((const Vector *) pVector);
+    if (max->vector == NULL || sqrNorm > max->sqrNorm)
+    {
+        max->vector = (const Vector *) pVector;
+        max->sqrNorm = sqrNorm;
+    }
     return 1;
 }
 
@@ -97,12 +271,316 @@ Vector *findMaxNormVectorInTree(RBTree *tree)
     {
         return 0;
     }
-    pMaxVector->vector = NULL;
-    pMaxVector->len = 0;
-    forEachRBTree(tree, copyIfNormIsLarger, pMaxVector);
+    initVector(pMaxVector, NULL, 0);
+    MaxNormAggregate max = {NULL, 0};
+    const MaxNormAggregate *treeMax = NULL;
+    if (tree->combineFunc == combineMaxNorm)
+    {
+        treeMax = (const MaxNormAggregate *) getRBTreeAggregate(tree);
+    }
+    if (treeMax != NULL) // the tree already knows its max.
+    {
+        max = *treeMax;
+    }
+    else
+    {
+        forEachRBTree(tree, trackMaxNorm, &max);
+    }
+    if (max.vector != NULL)
+    {
+        copyIfNormIsLarger(max.vector, pMaxVector);
+    }
     return pMaxVector;
 }
 
+/**
+ * @return other than 0 iff a should be dropped before b: a has a smaller norm, or an equal norm
+ * and a later position in the tree order.
+ */
+int isWorseNorm(const NormHeapEntry *a, const NormHeapEntry *b)
+{
+    return a->sqrNorm < b->sqrNorm || (a->sqrNorm == b->sqrNorm && a->rank > b->rank);
+}
+
+/**
+ * moves the entry at index down the heap until both its children are better than it.
+ * @param heap - NormHeap.
+ * @param index - index of the entry to move.
+ */
+void siftDownNormHeap(NormHeap *heap, int index)
+{
+    NormHeapEntry entry = heap->entries[index];
+    while (2 * index + 1 < heap->size)
+    {
+        int child = 2 * index + 1;
+        if (child + 1 < heap->size && isWorseNorm(&heap->entries[child + 1], &heap->entries[child]))
+        {
+            child++;
+        }
+        if (!isWorseNorm(&heap->entries[child], &entry))
+        {
+            break;
+        }
+        heap->entries[index] = heap->entries[child];
+        index = child;
+    }
+    heap->entries[index] = entry;
+}
+
+/**
+ * adds an entry to the heap if it isn't full, or replaces the worst entry if it is better.
+ * @param heap - NormHeap.
+ * @param entry - the entry to add.
+ */
+void pushNormHeap(NormHeap *heap, NormHeapEntry entry)
+{
+    if (heap->size < heap->capacity)
+    {
+        int index = heap->size++;
+        while (index > 0 && isWorseNorm(&entry, &heap->entries[(index - 1) / 2]))
+        {
+            heap->entries[index] = heap->entries[(index - 1) / 2];
+            index = (index - 1) / 2;
+        }
+        heap->entries[index] = entry;
+    }
+    else if (heap->capacity > 0 && isWorseNorm(&heap->entries[0], &entry))
+    {
+        heap->entries[0] = entry;
+        siftDownNormHeap(heap, 0);
+    }
+}
+
+/**
+ * ForEach function that offers pVector to a top k heap.
+ * @param pVector - Vector*
+ * @param pHeap - NormHeap*
+ * @return 1
+ */
+int offerToNormHeap(const void *pVector, void *pHeap)
+{
+    NormHeap *heap = (NormHeap *) pHeap;
+    NormHeapEntry entry = {(const Vector *) pVector, getCachedVectorSquaredNorm((Vector *) pVector),
+                           heap->nextRank++};
+    pushNormHeap(heap, entry);
+    return 1;
+}
+
+/**
+ * empties the heap into an array of copies of its vectors, in descending norm order.
+ * @param heap - NormHeap, its entries are reordered.
+ * @return the array, NULL on failure or if the heap is empty.
+ */
+Vector **copyNormHeap(NormHeap *heap)
+{
+    if (heap->size == 0)
+    {
+        return NULL;
+    }
+    int count = heap->size;
+    Vector **result = (Vector **) calloc(count, sizeof(Vector *));
+    if (result == NULL)
+    {
+        return NULL;
+    }
+    // pop the worst entry each time, filling the array from its end.
+    for (int i = count - 1; i >= 0; i--)
+    {
+        const Vector *worst = heap->entries[0].vector;
+        heap->entries[0] = heap->entries[--heap->size];
+        siftDownNormHeap(heap, 0);
+
+        result[i] = (Vector *) malloc(sizeof(Vector));
+        if (result[i] != NULL)
+        {
+            initVector(result[i], NULL, 0);
+        }
+        if (result[i] == NULL || copyIfNormIsLarger(worst, result[i]) == 0)
+        {
+            for (int j = i; j < count; j++)
+            {
+                freeVector(result[j]);
+            }
+            free(result);
+            return NULL;
+        }
+    }
+    return result;
+}
+
+/**
+ * @return the number of vectors a top k query returns: min(k, size).
+ */
+int getTopKCount(const RBTree *tree, int k)
+{
+    return (k < tree->size) ? k : tree->size;
+}
+
+Vector **findTopKNormVectors(RBTree *tree, int k)
+{
+    if (tree == NULL || getTopKCount(tree, k) <= 0)
+    {
+        return NULL;
+    }
+    NormHeap heap = {NULL, 0, getTopKCount(tree, k), 0};
+    heap.entries = (NormHeapEntry *) malloc(heap.capacity * sizeof(NormHeapEntry));
+    if (heap.entries == NULL)
+    {
+        return NULL;
+    }
+    forEachRBTree(tree, offerToNormHeap, &heap);
+    Vector **result = copyNormHeap(&heap);
+    free(heap.entries);
+    return result;
+}
+
+/**
+ * ForEach function that appends pVector to an array.
+ * @param pVector - Vector*
+ * @param pEnd - Vector*** pointing to the next free cell of the array.
+ * @return 1
+ */
+int gatherVector(const void *pVector, void *pEnd)
+{
+    Vector ***end = (Vector ***) pEnd;
+    **end = (Vector *) pVector;
+    (*end)++;
+    return 1;
+}
+
+int forEachVectorTree(void *tree, forEachFunc func, void *args)
+{
+    return forEachRBTree((RBTree *) tree, func, args);
+}
+
+Vector **flattenVectors(void *container, ForEachVectorFunc forEach, int size)
+{
+    // at least one cell, an empty container isn't a failure.
+    Vector **vectors = (Vector **) malloc(((size > 0) ? size : 1) * sizeof(Vector *));
+    if (vectors == NULL)
+    {
+        return NULL;
+    }
+    Vector **end = vectors;
+    forEach(container, gatherVector, &end);
+    return vectors;
+}
+
+int getPartStart(int n, int nParts, int part)
+{
+    return part * (n / nParts) + ((part < n % nParts) ? part : n % nParts);
+}
+
+void runParallelTasks(void *(*routine)(void *), void *tasks, size_t taskSize, int nTasks)
+{
+    pthread_t *threads = (pthread_t *) malloc(((nTasks > 0) ? nTasks : 1) * sizeof(pthread_t));
+    int *started = (int *) calloc((nTasks > 0) ? nTasks : 1, sizeof(int));
+    for (int i = 1; i < nTasks && threads != NULL && started != NULL; i++)
+    {
+        void *task = (char *) tasks + i * taskSize;
+        started[i] = (pthread_create(&threads[i], NULL, routine, task) == 0);
+    }
+    for (int i = 0; i < nTasks; i++)
+    {
+        if (started != NULL && started[i])
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            routine((char *) tasks + i * taskSize);
+        }
+    }
+    free(threads);
+    free(started);
+}
+
+/**
+ * thread routine of findTopKNormVectorsParallel, fills the heap of a task from its part.
+ * every vector belongs to a single task, so the norms are cached without races.
+ * @param pTask - TopKTask*
+ * @return NULL
+ */
+void *scanTopKTask(void *pTask)
+{
+    TopKTask *task = (TopKTask *) pTask;
+    task->heap.nextRank = task->first;
+    for (size_t i = task->first; i < task->first + task->count; i++)
+    {
+        offerToNormHeap(task->vectors[i], &task->heap);
+    }
+    return NULL;
+}
+
+Vector **findTopKNormVectorsParallel(RBTree *tree, int k, int nThreads)
+{
+    if (nThreads <= 1 || tree == NULL || tree->size < nThreads)
+    {
+        return findTopKNormVectors(tree, k);
+    }
+    int capacity = getTopKCount(tree, k);
+    if (capacity <= 0)
+    {
+        return NULL;
+    }
+    Vector **vectors = flattenVectors(tree, forEachVectorTree, tree->size);
+    TopKTask *tasks = (TopKTask *) calloc(nThreads, sizeof(TopKTask));
+    // one array for the heaps of all the tasks, and one more for merging them.
+    NormHeapEntry *entries = (NormHeapEntry *) malloc((size_t) (nThreads + 1) * capacity
+                                                      * sizeof(NormHeapEntry));
+    Vector **result = NULL;
+    if (vectors != NULL && tasks != NULL && entries != NULL)
+    {
+        for (int i = 0; i < nThreads; i++)
+        {
+            tasks[i].vectors = vectors;
+            tasks[i].first = getPartStart(tree->size, nThreads, i);
+            tasks[i].count = getPartStart(tree->size, nThreads, i + 1) - tasks[i].first;
+            tasks[i].heap.entries = entries + (size_t) i * capacity;
+            tasks[i].heap.capacity = capacity;
+        }
+        runParallelTasks(scanTopKTask, tasks, sizeof(TopKTask), nThreads);
+        NormHeap merged = {entries + (size_t) nThreads * capacity, 0, capacity, 0};
+        for (int i = 0; i < nThreads; i++)
+        {
+            for (int j = 0; j < tasks[i].heap.size; j++)
+            {
+                pushNormHeap(&merged, tasks[i].heap.entries[j]);
+            }
+        }
+        result = copyNormHeap(&merged);
+    }
+    free(entries);
+    free(tasks);
+    free(vectors);
+    return result;
+}
+
+void combineMaxNorm(void *aggregate, const void *data, const void *leftAggregate,
+                    const void *rightAggregate, void *args)
+{
+    (void) args;
+    MaxNormAggregate *result = (MaxNormAggregate *) aggregate;
+    const MaxNormAggregate *left = (const MaxNormAggregate *) leftAggregate;
+    const MaxNormAggregate *right = (const MaxNormAggregate *) rightAggregate;
+    double dataNorm = getCachedVectorSquaredNorm((Vector *) data);
+
+    // ties are broken in favor of the smaller vector, same as the in order scan.
+    if (left != NULL && left->sqrNorm >= dataNorm)
+    {
+        *result = *left;
+    }
+    else
+    {
+        result->vector = (const Vector *) data;
+        result->sqrNorm = dataNorm;
+    }
+    if (right != NULL && right->sqrNorm > result->sqrNorm)
+    {
+        *result = *right;
+    }
+}
+
 void freeVector(void *pVector)
 {
     Vector *v = (Vector *) pVector;
@@ -155,3 +633,129 @@ void freeString(void *s)
     }
 }
 
+/**
+ * ForEach function that adds the length of word and a separator to the total length of a join.
+ * @param word - char*
+ * @param pJoin - StringJoin*
+ * @return 1
+ */
+int addJoinLength(const void *word, void *pJoin)
+{
+    StringJoin *join = (StringJoin *) pJoin;
+    join->totalLen += strlen((const char *) word) + join->separatorLen;
+    return 1;
+}
+
+/**
+ * ForEach function that copies word and a separator to the end of a join, and moves the end.
+ * @param word - char*
+ * @param pJoin - StringJoin* with enough room after its end.
+ * @return 1
+ */
+int appendToJoin(const void *word, void *pJoin)
+{
+    StringJoin *join = (StringJoin *) pJoin;
+    size_t len = strlen((const char *) word);
+    memcpy(join->end, word, len);
+    memcpy(join->end + len, join->separator, join->separatorLen);
+    join->end += len + join->separatorLen;
+    return 1;
+}
+
+char *joinStringTree(RBTree *tree, const char *separator)
+{
+    if (tree == NULL || separator == NULL)
+    {
+        return NULL;
+    }
+    StringJoin join = {NULL, separator, strlen(separator), 0};
+    forEachRBTree(tree, addJoinLength, &join);
+    char *joined = (char *) malloc(join.totalLen + 1);
+    if (joined == NULL)
+    {
+        return NULL;
+    }
+    join.end = joined;
+    forEachRBTree(tree, appendToJoin, &join);
+    *join.end = '\0';
+    return joined;
+}
+
+/**
+ * writes all the words gathered in a StringWrite, resuming after partial writes.
+ * @param writer - StringWrite.
+ * @return 1 on success, 0 if writev failed.
+ */
+int flushStringWrite(StringWrite *writer)
+{
+    struct iovec *next = writer->batch;
+    int count = writer->count;
+    while (count > 0)
+    {
+        ssize_t written = writev(writer->fd, next, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return 0;
+        }
+        // skip the fully written iovecs, and advance inside the partially written one.
+        while (count > 0 && (size_t) written >= next->iov_len)
+        {
+            written -= (ssize_t) next->iov_len;
+            next++;
+            count--;
+        }
+        if (count > 0)
+        {
+            next->iov_base = (char *) next->iov_base + written;
+            next->iov_len -= (size_t) written;
+        }
+    }
+    writer->count = 0;
+    return 1;
+}
+
+/**
+ * ForEach function that gathers word and a separator for writing, writing when the batch is full.
+ * @param word - char*
+ * @param pWrite - StringWrite*
+ * @return 0 on failure, other on success
+ */
+int gatherForWrite(const void *word, void *pWrite)
+{
+    StringWrite *writer = (StringWrite *) pWrite;
+    if (writer->count + 2 > WRITE_BATCH_SIZE && flushStringWrite(writer) == 0)
+    {
+        return 0;
+    }
+    writer->batch[writer->count].iov_base = (void *) word;
+    writer->batch[writer->count].iov_len = strlen((const char *) word);
+    writer->batch[writer->count + 1].iov_base = (void *) writer->separator;
+    writer->batch[writer->count + 1].iov_len = writer->separatorLen;
+    writer->count += 2;
+    return 1;
+}
+
+int writeStringTree(RBTree *tree, int fd, const char *separator)
+{
+    if (tree == NULL || separator == NULL)
+    {
+        return 0;
+    }
+    StringWrite *writer = (StringWrite *) malloc(sizeof(StringWrite));
+    if (writer == NULL)
+    {
+        return 0;
+    }
+    writer->count = 0;
+    writer->fd = fd;
+    writer->separator = separator;
+    writer->separatorLen = strlen(separator);
+    int status = forEachRBTree(tree, gatherForWrite, writer) && flushStringWrite(writer);
+    free(writer);
+    return status;
+}
+
@@ -7,15 +7,82 @@
 #ifndef TA_EX3_STRUCTS_H
 #define TA_EX3_STRUCTS_H
 
+// flags of a Vector.
+#define VECTOR_NORM_CACHED 1 // sqrNorm holds the squared norm of the coefficients.
+#define VECTOR_FINGERPRINT_CACHED 4 // fingerprint holds the hash of the coefficients.
+#define VECTOR_EMPTY 8 // holds no coefficients, an empty destination of a max norm search.
+
 /**
  * Represents a vector. The double* should be dynamically allocated
+ * only len and vector have to be set. the cached fields are trusted only by the functions that say
+ * so (top k searches, combineMaxNorm, fingerprints), the vectors passed to them must be set up
+ * with initVector (or come from a VectorStore), and invalidateVectorCache must be called after
+ * their coefficients change.
  */
 typedef struct Vector
 {
 	int len;
 	double *vector;
+	int flags; // VECTOR_* flags.
+	double sqrNorm; // cached squared norm, valid iff flags & VECTOR_NORM_CACHED.
+	uint64_t fingerprint; // cached hash, valid iff flags & VECTOR_FINGERPRINT_CACHED.
 } Vector;
 
+/**
+ * sets up a vector over the given coefficients, with no cached norm.
+ * @param v - the vector.
+ * @param coefficients - dynamically allocated array of len doubles (or NULL).
+ * @param len - number of coefficients.
+ */
+void initVector(Vector *v, double *coefficients, int len);
+
+/**
+ * drops the cached norm and fingerprint of a vector, call it after changing its coefficients.
+ * @param v - the vector.
+ */
+void invalidateVectorCache(Vector *v);
+
+/**
+ * @param v - the vector, only its len and vector are read, so it doesn't need initVector.
+ * @return the squared L2 norm of v, computed on every call.
+ */
+double calcVectorSquaredNorm(const Vector *v);
+
+/**
+ * @param v - a vector set up with initVector.
+ * @return the squared L2 norm of v, computed on the first call and cached in v.
+ * (not thread safe on the first call for the same vector)
+ */
+double getCachedVectorSquaredNorm(Vector *v);
+
+/**
+ * @param v - the vector.
+ * @return a 64 bit hash of the length and the coefficients of v, computed on the first call and
+ * cached in v. vectors that vectorCompare1By1 finds equal have equal fingerprints (0.0 and -0.0
+ * hash the same), unless they hold NaNs.
+ */
+uint64_t getVectorFingerprint(Vector *v);
+
+/**
+ * checks whether two vectors are equal: vectors with different fingerprints are rejected at once,
+ * and only vectors with equal fingerprints are compared element by element.
+ * @param a - first vector
+ * @param b - second vector
+ * @return 1 if vectorCompare1By1(a, b) == 0, 0 otherwise.
+ */
+int vectorsEqual(const void *a, const void *b);
+
+/**
+ * removes the duplicates from an array of vectors in O(n) expected time, keeping the first
+ * appearance of every vector in its order. the vectors are put in a hash table by their
+ * fingerprints, so only vectors with equal fingerprints are compared element by element.
+ * the removed vectors aren't freed.
+ * @param vectors - array of pointers to vectors.
+ * @param n - number of vectors.
+ * @return the number of vectors left at the start of the array, -1 on failure.
+ */
+int dedupVectors(Vector **vectors, int n);
+
 
 /**
  * CompFunc for strings (assumes strings end with "\0")
@@ -40,6 +107,26 @@ int concatenate(const void *word, void *pConcatenated); // implement it in Struc
  */
 void freeString(void *s); // implement it in Structs.c
 
+/**
+ * joins the strings of a tree in ascending order, each followed by separator (as concatenate does
+ * with "\n"). the total length is computed first, so every string is copied once, in O(total
+ * length) rather than rescanning the result for every word.
+ * @param tree - a tree of strings.
+ * @param separator - string to add after every word.
+ * @return a new string allocated in the heap (to be freed by the caller), NULL on failure.
+ */
+char *joinStringTree(RBTree *tree, const char *separator);
+
+/**
+ * writes the strings of a tree in ascending order, each followed by separator, to a file
+ * descriptor. the strings are gathered with writev straight from the tree, with no buffer.
+ * @param tree - a tree of strings.
+ * @param fd - an open file descriptor.
+ * @param separator - string to write after every word.
+ * @return 0 on failure, other on success.
+ */
+int writeStringTree(RBTree *tree, int fd, const char *separator);
+
 /**
  * CompFunc for Vectors, compares element by element, the vector that has the first larger
  * element is considered larger. If vectors are of different lengths and identify for the length
@@ -51,13 +138,16 @@ void freeString(void *s); // implement it in Structs.c
 int vectorCompare1By1(const void *a, const void *b); // implement it in Structs.c
 
 /**
- * FreeFunc for vectors
+ * FreeFunc for vectors, frees the coefficients and the vector itself. vectors of a VectorStore
+ * are released with their store, a tree of them is freed with freeStoreVector.
  */
 void freeVector(void *pVector); // implement it in Structs.c
 
 /**
  * copy pVector to pMaxVector if : 1. The norm of pVector is greater then the norm of pMaxVector.
  * 								   2. pMaxVector == NULL.
+ * a vector whose norm isn't larger is not copied, and that is a success, so a forEach over a tree
+ * goes on to the next vector. the copyIfNormIsLarger of the other vector types do the same.
  * @param pVector pointer to Vector
  * @param pMaxVector pointer to Vector
  * @return 1 on success, 0 on failure (if pVector == NULL: failure).
@@ -65,10 +155,94 @@ void freeVector(void *pVector); // implement it in Structs.c
 int copyIfNormIsLarger(const void *pVector, void *pMaxVector); // implement it in Structs.c
 
 /**
+ * scans the tree for the largest norm vector keeping only a pointer to it, and copies it once at
+ * the end. every norm is computed once, and nothing is cached in the vectors. a tree built with
+ * combineMaxNorm already knows its max, and answers in O(1) with no scan.
  * @param tree a pointer to a tree of Vectors
  * @return pointer to a *copy* of the vector that has the largest norm (L2 Norm).
  */
 Vector *findMaxNormVectorInTree(RBTree *tree); // implement it in Structs.c You must use copyIfNormIsLarger in the implementation!
 
+/**
+ * finds the k vectors with the largest norms in a single scan of the tree, keeping the best k seen
+ * so far in a bounded min heap, in O(n log k) instead of k scans. ties are broken in favor of the
+ * smaller vector, as in findMaxNormVectorInTree.
+ * @param tree - a tree of Vectors set up with initVector, their norms are cached.
+ * @param k - number of vectors to find.
+ * @return array of min(k, tree->size) pointers to *copies* of the vectors, in descending norm
+ * order. every copy should be freed with freeVector and the array with free. NULL on failure or
+ * if the array is empty.
+ */
+Vector **findTopKNormVectors(RBTree *tree, int k);
+
+/**
+ * same as findTopKNormVectors, but the norms are computed and the heaps are kept by nThreads
+ * threads, each over a contiguous part of the tree order, and merged at the end. the result is the
+ * same as findTopKNormVectors. if a thread can't be started its part is scanned by the caller.
+ * @param tree - a tree of Vectors.
+ * @param k - number of vectors to find.
+ * @param nThreads - number of threads to use.
+ * @return see findTopKNormVectors.
+ */
+Vector **findTopKNormVectorsParallel(RBTree *tree, int k, int nThreads);
+
+/**
+ * ForEach of a container of Vectors, with the container untyped.
+ */
+typedef int (*ForEachVectorFunc)(void *container, forEachFunc func, void *args);
+
+/**
+ * forEachRBTree with an untyped tree, the ForEachVectorFunc of a tree of Vectors.
+ */
+int forEachVectorTree(void *tree, forEachFunc func, void *args);
+
+/**
+ * copies the pointers to the vectors of a container to an array, in the order of its ForEach, so
+ * they can be indexed and split between threads.
+ * @param container - a container of Vectors.
+ * @param forEach - ForEach of the container: forEachVectorTree for a tree.
+ * @param size - number of vectors in the container.
+ * @return array of the size pointers, should be freed with free. NULL on failure.
+ */
+Vector **flattenVectors(void *container, ForEachVectorFunc forEach, int size);
+
+/**
+ * splits n items to nParts contiguous parts, their sizes differ by at most 1.
+ * @return the index of the first item of the given part, n for part nParts.
+ */
+int getPartStart(int n, int nParts, int part);
+
+/**
+ * runs a thread routine on every task of an array, each on its own thread. the caller runs the
+ * first task itself, and every task whose thread can't be started, so all the tasks are always run.
+ * @param routine - gets a pointer to its task.
+ * @param tasks - array of nTasks tasks.
+ * @param taskSize - size of a task in bytes.
+ * @param nTasks - number of tasks.
+ */
+void runParallelTasks(void *(*routine)(void *), void *tasks, size_t taskSize, int nTasks);
+
+/**
+ * Aggregate of a subtree of Vectors, holds the vector with the largest norm in the subtree.
+ */
+typedef struct MaxNormAggregate
+{
+	const Vector *vector;
+	double sqrNorm;
+} MaxNormAggregate;
+
+/**
+ * CombineFunc for augmented trees of Vectors, keeps the largest norm vector of every subtree.
+ * a tree constructed with it answers findMaxNormVectorInTree in O(1) instead of a full scan:
+ * newAugmentedRBTree(vectorCompare1By1, freeVector, combineMaxNorm, sizeof(MaxNormAggregate), NULL)
+ * @param aggregate - MaxNormAggregate to fill.
+ * @param data - Vector in the subtree root, set up with initVector, its norm is cached.
+ * @param leftAggregate - MaxNormAggregate of the left subtree or NULL.
+ * @param rightAggregate - MaxNormAggregate of the right subtree or NULL.
+ * @param args - unused.
+ */
+void combineMaxNorm(void *aggregate, const void *data, const void *leftAggregate,
+					const void *rightAggregate, void *args);
+
 
 #endif //TA_EX3_STRUCTS_H
@@ -0,0 +1,552 @@
+#include "VectorKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+#define SIMD_MIN_LEN 8 // below that the dispatch costs more than the vector instructions save.
+#define INT8_BLOCK_LEN 32768 // bytes summed in 32 bit lanes before they could overflow.
+
+
+/**
+ * compareDoubles with a plain loop, for the platforms without SIMD and for the tails.
+ */
+int compareDoublesScalar(const double *a, const double *b, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        if (a[i] > b[i])
+        {
+            return 1;
+        }
+        else if (a[i] < b[i])
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquares with a plain loop, for the platforms without SIMD and for the tails.
+ * the four sums are independent, so each addition doesn't wait for the one before it.
+ */
+double sumOfSquaresScalar(const double *a, int len)
+{
+    double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        sum0 += a[i] * a[i];
+        sum1 += a[i + 1] * a[i + 1];
+        sum2 += a[i + 2] * a[i + 2];
+        sum3 += a[i + 3] * a[i + 3];
+    }
+    for (; i < len; i++)
+    {
+        sum0 += a[i] * a[i];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * dotProduct with a plain loop, see sumOfSquaresScalar.
+ */
+double dotProductScalar(const double *a, const double *b, int len)
+{
+    double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        sum0 += a[i] * b[i];
+        sum1 += a[i + 1] * b[i + 1];
+        sum2 += a[i + 2] * b[i + 2];
+        sum3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < len; i++)
+    {
+        sum0 += a[i] * b[i];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * compareFloats with a plain loop.
+ */
+int compareFloatsScalar(const float *a, const float *b, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        if (a[i] > b[i])
+        {
+            return 1;
+        }
+        else if (a[i] < b[i])
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquaresFloats with a plain loop, see sumOfSquaresScalar.
+ */
+double sumOfSquaresFloatsScalar(const float *a, int len)
+{
+    double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        sum0 += (double) a[i] * a[i];
+        sum1 += (double) a[i + 1] * a[i + 1];
+        sum2 += (double) a[i + 2] * a[i + 2];
+        sum3 += (double) a[i + 3] * a[i + 3];
+    }
+    for (; i < len; i++)
+    {
+        sum0 += (double) a[i] * a[i];
+    }
+    return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * compareInt8 with a plain loop.
+ */
+int compareInt8Scalar(const int8_t *a, const int8_t *b, int len)
+{
+    for (int i = 0; i < len; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquaresInt8 with a plain loop.
+ */
+int64_t sumOfSquaresInt8Scalar(const int8_t *a, int len)
+{
+    int64_t sum = 0;
+    for (int i = 0; i < len; i++)
+    {
+        sum += a[i] * a[i];
+    }
+    return sum;
+}
+
+#ifdef VECTOR_KERNELS_X86
+
+/**
+ * compareDoubles, 2 lanes at a time. lanes that are neither < nor > (equal or NaN) are skipped,
+ * the first lane set in the mask is the first differing element.
+ */
+__attribute__((target("sse2")))
+int compareDoublesSSE2(const double *a, const double *b, int len)
+{
+    int i = 0;
+    for (; i + 2 <= len; i += 2)
+    {
+        __m128d va = _mm_loadu_pd(a + i);
+        __m128d vb = _mm_loadu_pd(b + i);
+        int greater = _mm_movemask_pd(_mm_cmpgt_pd(va, vb));
+        int differ = greater | _mm_movemask_pd(_mm_cmplt_pd(va, vb));
+        if (differ != 0)
+        {
+            int lane = __builtin_ctz((unsigned) differ);
+            return ((greater >> lane) & 1) ? 1 : -1;
+        }
+    }
+    return compareDoublesScalar(a + i, b + i, len - i);
+}
+
+/**
+ * sumOfSquares, 4 accumulators of 2 lanes.
+ */
+__attribute__((target("sse2")))
+double sumOfSquaresSSE2(const double *a, int len)
+{
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    __m128d sum2 = _mm_setzero_pd(), sum3 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        __m128d v0 = _mm_loadu_pd(a + i), v1 = _mm_loadu_pd(a + i + 2);
+        __m128d v2 = _mm_loadu_pd(a + i + 4), v3 = _mm_loadu_pd(a + i + 6);
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(v0, v0));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(v1, v1));
+        sum2 = _mm_add_pd(sum2, _mm_mul_pd(v2, v2));
+        sum3 = _mm_add_pd(sum3, _mm_mul_pd(v3, v3));
+    }
+    __m128d sum = _mm_add_pd(_mm_add_pd(sum0, sum1), _mm_add_pd(sum2, sum3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    double total = lanes[0] + lanes[1];
+    for (; i < len; i++)
+    {
+        total += a[i] * a[i];
+    }
+    return total;
+}
+
+/**
+ * dotProduct, 4 accumulators of 2 lanes.
+ */
+__attribute__((target("sse2")))
+double dotProductSSE2(const double *a, const double *b, int len)
+{
+    __m128d sum0 = _mm_setzero_pd(), sum1 = _mm_setzero_pd();
+    __m128d sum2 = _mm_setzero_pd(), sum3 = _mm_setzero_pd();
+    int i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        sum2 = _mm_add_pd(sum2, _mm_mul_pd(_mm_loadu_pd(a + i + 4), _mm_loadu_pd(b + i + 4)));
+        sum3 = _mm_add_pd(sum3, _mm_mul_pd(_mm_loadu_pd(a + i + 6), _mm_loadu_pd(b + i + 6)));
+    }
+    __m128d sum = _mm_add_pd(_mm_add_pd(sum0, sum1), _mm_add_pd(sum2, sum3));
+    double lanes[2];
+    _mm_storeu_pd(lanes, sum);
+    double total = lanes[0] + lanes[1];
+    for (; i < len; i++)
+    {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+/**
+ * compareDoubles, 4 lanes at a time, see compareDoublesSSE2.
+ */
+__attribute__((target("avx2")))
+int compareDoublesAVX2(const double *a, const double *b, int len)
+{
+    int i = 0;
+    for (; i + 4 <= len; i += 4)
+    {
+        __m256d va = _mm256_loadu_pd(a + i);
+        __m256d vb = _mm256_loadu_pd(b + i);
+        int greater = _mm256_movemask_pd(_mm256_cmp_pd(va, vb, _CMP_GT_OQ));
+        int differ = greater | _mm256_movemask_pd(_mm256_cmp_pd(va, vb, _CMP_LT_OQ));
+        if (differ != 0)
+        {
+            int lane = __builtin_ctz((unsigned) differ);
+            return ((greater >> lane) & 1) ? 1 : -1;
+        }
+    }
+    // the tail stays in this function, calling legacy SSE code with the upper lanes in use is slow.
+    for (; i < len; i++)
+    {
+        if (a[i] > b[i])
+        {
+            return 1;
+        }
+        else if (a[i] < b[i])
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquares, 4 accumulators of 4 lanes.
+ */
+__attribute__((target("avx2")))
+double sumOfSquaresAVX2(const double *a, int len)
+{
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m256d v0 = _mm256_loadu_pd(a + i), v1 = _mm256_loadu_pd(a + i + 4);
+        __m256d v2 = _mm256_loadu_pd(a + i + 8), v3 = _mm256_loadu_pd(a + i + 12);
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(v0, v0));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(v1, v1));
+        sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(v2, v2));
+        sum3 = _mm256_add_pd(sum3, _mm256_mul_pd(v3, v3));
+    }
+    for (; i + 4 <= len; i += 4)
+    {
+        __m256d v = _mm256_loadu_pd(a + i);
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(v, v));
+    }
+    __m256d sum = _mm256_add_pd(_mm256_add_pd(sum0, sum1), _mm256_add_pd(sum2, sum3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < len; i++)
+    {
+        total += a[i] * a[i];
+    }
+    return total;
+}
+
+/**
+ * dotProduct, 4 accumulators of 4 lanes.
+ */
+__attribute__((target("avx2")))
+double dotProductAVX2(const double *a, const double *b, int len)
+{
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(_mm256_loadu_pd(a + i + 4),
+                                                 _mm256_loadu_pd(b + i + 4)));
+        sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(_mm256_loadu_pd(a + i + 8),
+                                                 _mm256_loadu_pd(b + i + 8)));
+        sum3 = _mm256_add_pd(sum3, _mm256_mul_pd(_mm256_loadu_pd(a + i + 12),
+                                                 _mm256_loadu_pd(b + i + 12)));
+    }
+    for (; i + 4 <= len; i += 4)
+    {
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    __m256d sum = _mm256_add_pd(_mm256_add_pd(sum0, sum1), _mm256_add_pd(sum2, sum3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < len; i++)
+    {
+        total += a[i] * b[i];
+    }
+    return total;
+}
+
+/**
+ * compareFloats, 8 lanes at a time, see compareDoublesSSE2.
+ */
+__attribute__((target("avx2")))
+int compareFloatsAVX2(const float *a, const float *b, int len)
+{
+    int i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        int greater = _mm256_movemask_ps(_mm256_cmp_ps(va, vb, _CMP_GT_OQ));
+        int differ = greater | _mm256_movemask_ps(_mm256_cmp_ps(va, vb, _CMP_LT_OQ));
+        if (differ != 0)
+        {
+            int lane = __builtin_ctz((unsigned) differ);
+            return ((greater >> lane) & 1) ? 1 : -1;
+        }
+    }
+    for (; i < len; i++)
+    {
+        if (a[i] > b[i])
+        {
+            return 1;
+        }
+        else if (a[i] < b[i])
+        {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquaresFloats, every 4 floats are widened to 4 doubles before they are squared.
+ */
+__attribute__((target("avx2")))
+double sumOfSquaresFloatsAVX2(const float *a, int len)
+{
+    __m256d sum0 = _mm256_setzero_pd(), sum1 = _mm256_setzero_pd();
+    __m256d sum2 = _mm256_setzero_pd(), sum3 = _mm256_setzero_pd();
+    int i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m256d v0 = _mm256_cvtps_pd(_mm_loadu_ps(a + i));
+        __m256d v1 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4));
+        __m256d v2 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 8));
+        __m256d v3 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 12));
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(v0, v0));
+        sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(v1, v1));
+        sum2 = _mm256_add_pd(sum2, _mm256_mul_pd(v2, v2));
+        sum3 = _mm256_add_pd(sum3, _mm256_mul_pd(v3, v3));
+    }
+    for (; i + 4 <= len; i += 4)
+    {
+        __m256d v = _mm256_cvtps_pd(_mm_loadu_ps(a + i));
+        sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(v, v));
+    }
+    __m256d sum = _mm256_add_pd(_mm256_add_pd(sum0, sum1), _mm256_add_pd(sum2, sum3));
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    double total = _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    for (; i < len; i++)
+    {
+        total += (double) a[i] * a[i];
+    }
+    return total;
+}
+
+/**
+ * compareInt8, 32 lanes at a time: the first lane that isn't equal is the first differing element.
+ */
+__attribute__((target("avx2")))
+int compareInt8AVX2(const int8_t *a, const int8_t *b, int len)
+{
+    int i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+        unsigned differ = ~(unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (differ != 0)
+        {
+            int lane = __builtin_ctz(differ);
+            return (a[i + lane] > b[i + lane]) ? 1 : -1;
+        }
+    }
+    for (; i < len; i++)
+    {
+        if (a[i] != b[i])
+        {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * sumOfSquaresInt8, every 16 bytes are widened to 16 bit lanes and multiplied and added in pairs
+ * to 32 bit lanes, which are added to the 64 bit total once per INT8_BLOCK_LEN bytes.
+ */
+__attribute__((target("avx2")))
+int64_t sumOfSquaresInt8AVX2(const int8_t *a, int len)
+{
+    int64_t total = 0;
+    int i = 0;
+    while (i + 16 <= len)
+    {
+        int blockEnd = (len - i > INT8_BLOCK_LEN) ? i + INT8_BLOCK_LEN : len;
+        __m256i sum = _mm256_setzero_si256();
+        for (; i + 16 <= blockEnd; i += 16)
+        {
+            __m256i v = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *) (a + i)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(v, v));
+        }
+        int lanes[8];
+        _mm256_storeu_si256((__m256i *) lanes, sum);
+        for (int lane = 0; lane < 8; lane++)
+        {
+            total += lanes[lane];
+        }
+    }
+    for (; i < len; i++)
+    {
+        total += a[i] * a[i];
+    }
+    return total;
+}
+
+#endif //VECTOR_KERNELS_X86
+
+int compareDoubles(const double *a, const double *b, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len < SIMD_MIN_LEN)
+    {
+        return compareDoublesScalar(a, b, len);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return compareDoublesAVX2(a, b, len);
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return compareDoublesSSE2(a, b, len);
+    }
+#endif
+    return compareDoublesScalar(a, b, len);
+}
+
+double sumOfSquares(const double *a, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len < SIMD_MIN_LEN)
+    {
+        return sumOfSquaresScalar(a, len);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return sumOfSquaresAVX2(a, len);
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return sumOfSquaresSSE2(a, len);
+    }
+#endif
+    return sumOfSquaresScalar(a, len);
+}
+
+double dotProduct(const double *a, const double *b, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len < SIMD_MIN_LEN)
+    {
+        return dotProductScalar(a, b, len);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return dotProductAVX2(a, b, len);
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return dotProductSSE2(a, b, len);
+    }
+#endif
+    return dotProductScalar(a, b, len);
+}
+
+int compareFloats(const float *a, const float *b, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len >= SIMD_MIN_LEN && __builtin_cpu_supports("avx2"))
+    {
+        return compareFloatsAVX2(a, b, len);
+    }
+#endif
+    return compareFloatsScalar(a, b, len);
+}
+
+double sumOfSquaresFloats(const float *a, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len >= SIMD_MIN_LEN && __builtin_cpu_supports("avx2"))
+    {
+        return sumOfSquaresFloatsAVX2(a, len);
+    }
+#endif
+    return sumOfSquaresFloatsScalar(a, len);
+}
+
+int compareInt8(const int8_t *a, const int8_t *b, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len >= SIMD_MIN_LEN && __builtin_cpu_supports("avx2"))
+    {
+        return compareInt8AVX2(a, b, len);
+    }
+#endif
+    return compareInt8Scalar(a, b, len);
+}
+
+int64_t sumOfSquaresInt8(const int8_t *a, int len)
+{
+#ifdef VECTOR_KERNELS_X86
+    if (len >= SIMD_MIN_LEN && __builtin_cpu_supports("avx2"))
+    {
+        return sumOfSquaresInt8AVX2(a, len);
+    }
+#endif
+    return sumOfSquaresInt8Scalar(a, len);
+}
@@ -0,0 +1,68 @@
+#ifndef TA_EX3_VECTORKERNELS_H
+#define TA_EX3_VECTORKERNELS_H
+
+#include <stdint.h>
+
+/**
+ * Kernels over arrays of doubles used by the Vector functions. On x86 the widest instruction set
+ * the cpu supports (AVX2 or SSE2) is picked at run time, other platforms use plain loops.
+ */
+
+/**
+ * compares two arrays element by element, the array that has the first larger element is
+ * considered larger. NaN elements are considered equal to anything, as in a loop of < and >.
+ * @param a - first array
+ * @param b - second array
+ * @param len - number of elements to compare.
+ * @return 1 if a > b, -1 if a < b, 0 if the first len elements are equal.
+ */
+int compareDoubles(const double *a, const double *b, int len);
+
+/**
+ * @param a - array of doubles.
+ * @param len - number of elements.
+ * @return the sum of the squares of the elements.
+ */
+double sumOfSquares(const double *a, int len);
+
+/**
+ * @param a - first array of doubles.
+ * @param b - second array of doubles.
+ * @param len - number of elements.
+ * @return the sum of the products of the elements, a[i] * b[i].
+ */
+double dotProduct(const double *a, const double *b, int len);
+
+/**
+ * compareDoubles for arrays of floats.
+ * @param a - first array
+ * @param b - second array
+ * @param len - number of elements to compare.
+ * @return 1 if a > b, -1 if a < b, 0 if the first len elements are equal.
+ */
+int compareFloats(const float *a, const float *b, int len);
+
+/**
+ * @param a - array of floats.
+ * @param len - number of elements.
+ * @return the sum of the squares of the elements, accumulated in doubles.
+ */
+double sumOfSquaresFloats(const float *a, int len);
+
+/**
+ * compareDoubles for arrays of signed bytes.
+ * @param a - first array
+ * @param b - second array
+ * @param len - number of elements to compare.
+ * @return 1 if a > b, -1 if a < b, 0 if the first len elements are equal.
+ */
+int compareInt8(const int8_t *a, const int8_t *b, int len);
+
+/**
+ * @param a - array of signed bytes.
+ * @param len - number of elements.
+ * @return the exact sum of the squares of the elements.
+ */
+int64_t sumOfSquaresInt8(const int8_t *a, int len);
+
+#endif //TA_EX3_VECTORKERNELS_H
@@ -0,0 +1,319 @@
+#define _POSIX_C_SOURCE 200809L // for mmap and posix_madvise with -std=c99
+#include "VectorLoader.h"
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define MAX_EXACT_DIGITS 15 // any integer of this many decimal digits is exact in a double.
+#define MAX_EXACT_POWER 22 // the largest power of 10 that is exact in a double.
+#define MAX_NUMBER_LEN 127 // longest number passed to strtod.
+#define MIN_LINE_CAPACITY 16
+
+/**
+ * the state of a load: the coefficients of the current line, and the vectors read so far.
+ */
+typedef struct VectorLoad
+{
+    double *line;
+    int lineLen;
+    int lineCapacity;
+    void **vectors;
+    int nVectors;
+    int vectorsCapacity;
+} VectorLoad;
+
+/**
+ * @return other than 0 iff c separates numbers in a line.
+ */
+int isVectorSeparator(char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+/**
+ * converts a number with strtod, from a copy that ends with '\0' (the mapped file doesn't).
+ * @param start - first char of the number.
+ * @param len - number of chars in the number.
+ * @param value - will be updated with the number.
+ * @return 1 on success, 0 if it isn't a number.
+ */
+int parseDoubleSlow(const char *start, size_t len, double *value)
+{
+    char copy[MAX_NUMBER_LEN + 1];
+    if (len == 0 || len > MAX_NUMBER_LEN)
+    {
+        return 0;
+    }
+    memcpy(copy, start, len);
+    copy[len] = '\0';
+    char *end;
+    *value = strtod(copy, &end);
+    return end == copy + len;
+}
+
+/**
+ * converts a decimal number. when the digits fit in MAX_EXACT_DIGITS and the exponent in
+ * MAX_EXACT_POWER, both the digits and the power of 10 are exact doubles, so a single rounded
+ * multiplication or division gives the correctly rounded number, as strtod would. anything else
+ * (more digits, large exponents, inf, nan, hex) is passed to strtod.
+ * @param start - first char of the number.
+ * @param len - number of chars in the number.
+ * @param value - will be updated with the number.
+ * @return 1 on success, 0 if it isn't a number.
+ */
+int parseDouble(const char *start, size_t len, double *value)
+{
+    static const double powersOf10[MAX_EXACT_POWER + 1] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    const char *p = start, *end = start + len;
+    int negative = (p < end && (*p == '-' || *p == '+')) ? (*p++ == '-') : 0;
+    uint64_t digits = 0;
+    int nDigits = 0, exponent = 0, seenDigit = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, seenDigit = 1)
+    {
+        if (nDigits > 0 || *p != '0') // leading zeros aren't significant.
+        {
+            digits = digits * 10 + (uint64_t) (*p - '0');
+            nDigits++;
+        }
+    }
+    if (p < end && *p == '.')
+    {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, seenDigit = 1)
+        {
+            if (nDigits > 0 || *p != '0')
+            {
+                digits = digits * 10 + (uint64_t) (*p - '0');
+                nDigits++;
+            }
+            exponent--;
+        }
+    }
+    if (seenDigit && p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        int negativeExponent = (q < end && (*q == '-' || *q == '+')) ? (*q++ == '-') : 0;
+        int written = 0, seenExponentDigit = 0;
+        for (; q < end && *q >= '0' && *q <= '9'; q++, seenExponentDigit = 1)
+        {
+            written = (written < 10000) ? written * 10 + (*q - '0') : written;
+        }
+        if (seenExponentDigit)
+        {
+            exponent += negativeExponent ? -written : written;
+            p = q;
+        }
+    }
+    if (!seenDigit || p != end || nDigits > MAX_EXACT_DIGITS || exponent > MAX_EXACT_POWER ||
+        exponent < -MAX_EXACT_POWER)
+    {
+        return parseDoubleSlow(start, len, value);
+    }
+    double result = (double) digits;
+    result = (exponent < 0) ? result / powersOf10[-exponent] : result * powersOf10[exponent];
+    *value = negative ? -result : result;
+    return 1;
+}
+
+/**
+ * appends a coefficient to the current line of a load.
+ * @return 0 on failure, other on success.
+ */
+int pushLineCoefficient(VectorLoad *load, double value)
+{
+    if (load->lineLen == load->lineCapacity)
+    {
+        int capacity = (load->lineCapacity > 0) ? 2 * load->lineCapacity : MIN_LINE_CAPACITY;
+        double *line = (double *) realloc(load->line, capacity * sizeof(double));
+        if (line == NULL)
+        {
+            return 0;
+        }
+        load->line = line;
+        load->lineCapacity = capacity;
+    }
+    load->line[load->lineLen++] = value;
+    return 1;
+}
+
+/**
+ * copies the current line of a load to a new vector of the store.
+ * @return 0 on failure, other on success.
+ */
+int storeLoadedLine(VectorLoad *load, VectorStore *store)
+{
+    if (load->nVectors == load->vectorsCapacity)
+    {
+        int capacity = (load->vectorsCapacity > 0) ? 2 * load->vectorsCapacity : MIN_LINE_CAPACITY;
+        void **vectors = (void **) realloc(load->vectors, capacity * sizeof(void *));
+        if (vectors == NULL)
+        {
+            return 0;
+        }
+        load->vectors = vectors;
+        load->vectorsCapacity = capacity;
+    }
+    Vector *v = addToVectorStore(store, load->line, load->lineLen);
+    if (v == NULL)
+    {
+        return 0;
+    }
+    load->vectors[load->nVectors++] = v;
+    load->lineLen = 0;
+    return 1;
+}
+
+/**
+ * parses the vectors of a mapped file in a single pass.
+ * @return 0 on failure, other on success.
+ */
+int parseVectorText(const char *text, size_t size, VectorStore *store, VectorLoad *load)
+{
+    const char *p = text, *end = text + size;
+    while (p < end)
+    {
+        if (*p == '\n')
+        {
+            if (load->lineLen > 0 && storeLoadedLine(load, store) == 0)
+            {
+                return 0;
+            }
+            p++;
+        }
+        else if (isVectorSeparator(*p))
+        {
+            p++;
+        }
+        else
+        {
+            const char *start = p;
+            while (p < end && *p != '\n' && !isVectorSeparator(*p))
+            {
+                p++;
+            }
+            double value;
+            if (parseDouble(start, p - start, &value) == 0 || pushLineCoefficient(load, value) == 0)
+            {
+                return 0;
+            }
+        }
+    }
+    return load->lineLen == 0 || storeLoadedLine(load, store);
+}
+
+/**
+ * sorts items[low, high) with a merge sort by the tree order.
+ * @param scratch - room for high - low items.
+ */
+void sortLoadedVectors(void **items, void **scratch, int low, int high, CompareFunc compFunc)
+{
+    if (high - low < 2)
+    {
+        return;
+    }
+    int middle = low + (high - low) / 2;
+    sortLoadedVectors(items, scratch, low, middle, compFunc);
+    sortLoadedVectors(items, scratch, middle, high, compFunc);
+    if (compFunc(items[middle - 1], items[middle]) <= 0) // already in order, e.g. a sorted file.
+    {
+        return;
+    }
+    int i = low, j = middle, next = 0;
+    while (i < middle && j < high)
+    {
+        scratch[next++] = (compFunc(items[j], items[i]) < 0) ? items[j++] : items[i++];
+    }
+    while (i < middle)
+    {
+        scratch[next++] = items[i++];
+    }
+    memcpy(items + low, scratch, (size_t) (j - low) * sizeof(void *));
+}
+
+/**
+ * sorts the vectors of a load, drops the duplicates and adds the rest to the tree.
+ * @return 0 on failure, other on success.
+ */
+int addLoadedVectors(VectorLoad *load, RBTree *tree)
+{
+    if (load->nVectors == 0)
+    {
+        return 1;
+    }
+    void **scratch = (void **) malloc(load->nVectors * sizeof(void *));
+    if (scratch == NULL)
+    {
+        return 0;
+    }
+    sortLoadedVectors(load->vectors, scratch, 0, load->nVectors, tree->compFunc);
+    free(scratch);
+    int unique = 1;
+    for (int i = 1; i < load->nVectors; i++)
+    {
+        if (tree->compFunc(load->vectors[unique - 1], load->vectors[i]) != 0)
+        {
+            load->vectors[unique++] = load->vectors[i];
+        }
+    }
+    if (tree->root == NULL)
+    {
+        return addSortedToRBTree(tree, load->vectors, unique);
+    }
+    for (int i = 0; i < unique; i++)
+    {
+        if (addToRBTreeHint(tree, load->vectors[i], tree->lastAdded) == 0 &&
+            containsRBTree(tree, load->vectors[i]) == 0)
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int loadVectorFile(const char *path, VectorStore *store, RBTree *tree)
+{
+    if (path == NULL || store == NULL || tree == NULL || tree->compFunc == NULL)
+    {
+        return 0;
+    }
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return 0;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return 0;
+    }
+    size_t size = (size_t) info.st_size;
+    void *text = NULL;
+    if (size > 0)
+    {
+        text = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (text == MAP_FAILED)
+    {
+        return 0;
+    }
+    if (text != NULL)
+    {
+        posix_madvise(text, size, POSIX_MADV_SEQUENTIAL);
+    }
+    VectorLoad load = {NULL, 0, 0, NULL, 0, 0};
+    int status = (text == NULL || parseVectorText((const char *) text, size, store, &load)) &&
+                 addLoadedVectors(&load, tree);
+    if (text != NULL)
+    {
+        munmap(text, size);
+    }
+    free(load.line);
+    free(load.vectors);
+    return status;
+}
@@ -0,0 +1,25 @@
+#ifndef TA_EX3_VECTORLOADER_H
+#define TA_EX3_VECTORLOADER_H
+
+#include "VectorStore.h"
+
+/**
+ * loads a text file of vectors into a store and a tree. every line that isn't empty is a vector,
+ * its coefficients are decimal numbers separated by spaces, tabs or commas.
+ * the file is mapped to memory and parsed in place: numbers of up to 15 significant digits with a
+ * small exponent are converted exactly with a single multiplication or division, the others with
+ * strtod. the vectors are written straight to the store, sorted, and added to the tree:
+ * an empty tree is built in O(n) with addSortedToRBTree, other trees get one insertion per vector
+ * next to the previous one.
+ * vectors that are already in the tree or appear twice in the file stay in the store but are not
+ * added to the tree.
+ * @param path: path of the file.
+ * @param store: store to add the vectors to.
+ * @param tree: a tree of Vectors ordered by a CompareFunc (e.g. vectorCompare1By1), whose
+ * FreeFunc leaves the vectors to the store (freeStoreVector).
+ * @return: 0 on failure (the file can't be read, a coefficient isn't a number, or memory
+ * allocation failed, the vectors read until then stay in the store), other on success.
+ */
+int loadVectorFile(const char *path, VectorStore *store, RBTree *tree);
+
+#endif //TA_EX3_VECTORLOADER_H
@@ -0,0 +1,124 @@
+#include "VectorScores.h"
+#include "VectorKernels.h"
+#include <stdlib.h>
+#include <math.h>
+
+/**
+ * a part of the vectors scored by a single thread.
+ */
+typedef struct ScoreTask
+{
+    Vector *const *vectors;
+    int count;
+    const Vector *query;
+    double queryNorm;
+    ScoreType type;
+    double *scores;
+} ScoreTask;
+
+/**
+ * thread routine of scoreVectors, scores the vectors of a task.
+ * @param pTask - ScoreTask*
+ * @return NULL
+ */
+void *scoreTaskVectors(void *pTask)
+{
+    const ScoreTask *task = (const ScoreTask *) pTask;
+    const Vector *q = task->query;
+    for (int i = 0; i < task->count; i++)
+    {
+        Vector *v = task->vectors[i];
+        int len = (v->len < q->len) ? v->len : q->len;
+        double dot = (len > 0) ? dotProduct(v->vector, q->vector, len) : 0;
+        if (task->type == COSINE_SCORE)
+        {
+            double norms = sqrt(getCachedVectorSquaredNorm(v)) * task->queryNorm;
+            dot = (norms > 0) ? dot / norms : 0;
+        }
+        task->scores[i] = dot;
+    }
+    return NULL;
+}
+
+int scoreVectors(Vector *const *vectors, int n, const Vector *q, ScoreType type, double *scores,
+                 int nThreads)
+{
+    if ((vectors == NULL && n > 0) || q == NULL || scores == NULL || n < 0)
+    {
+        return 0;
+    }
+    if (nThreads > n)
+    {
+        nThreads = n; // no thread gets an empty part.
+    }
+    if (nThreads < 1)
+    {
+        nThreads = 1;
+    }
+    ScoreTask *tasks = (ScoreTask *) malloc(nThreads * sizeof(ScoreTask));
+    if (tasks == NULL)
+    {
+        return 0;
+    }
+    double queryNorm = (q->len > 0) ? sqrt(sumOfSquares(q->vector, q->len)) : 0;
+    for (int i = 0; i < nThreads; i++)
+    {
+        int first = getPartStart(n, nThreads, i);
+        tasks[i].vectors = vectors + first;
+        tasks[i].count = getPartStart(n, nThreads, i + 1) - first;
+        tasks[i].query = q;
+        tasks[i].queryNorm = queryNorm;
+        tasks[i].type = type;
+        tasks[i].scores = scores + first;
+    }
+    runParallelTasks(scoreTaskVectors, tasks, sizeof(ScoreTask), nThreads);
+    free(tasks);
+    return 1;
+}
+
+/**
+ * gathers the vectors of a tree or a store to an array and scores them.
+ * @param forEach - ForEach of the container: forEachVectorTree or forEachScoredVectorStore.
+ * @param size - number of vectors in the container.
+ * @return 0 on failure, other on success.
+ */
+int scoreGatheredVectors(void *container, ForEachVectorFunc forEach, int size, const Vector *q,
+                         ScoreType type, double *scores, int nThreads)
+{
+    Vector **vectors = flattenVectors(container, forEach, size);
+    if (vectors == NULL)
+    {
+        return 0;
+    }
+    int status = scoreVectors(vectors, size, q, type, scores, nThreads);
+    free(vectors);
+    return status;
+}
+
+/**
+ * forEachVectorStore with an untyped store, for scoreGatheredVectors.
+ */
+int forEachScoredVectorStore(void *store, forEachFunc func, void *args)
+{
+    return forEachVectorStore((VectorStore *) store, func, args);
+}
+
+int scoreRBTree(RBTree *tree, const Vector *q, ScoreType type, double *scores, int nThreads)
+{
+    if (tree == NULL)
+    {
+        return 0;
+    }
+    return scoreGatheredVectors(tree, forEachVectorTree, tree->size, q, type, scores, nThreads);
+}
+
+int scoreVectorStore(VectorStore *store, const Vector *q, ScoreType type, double *scores,
+                     int nThreads)
+{
+    if (store == NULL)
+    {
+        return 0;
+    }
+    return scoreGatheredVectors(store, forEachScoredVectorStore, store->size, q, type, scores,
+                                nThreads);
+}
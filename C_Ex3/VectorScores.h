@@ -0,0 +1,54 @@
+#ifndef TA_EX3_VECTORSCORES_H
+#define TA_EX3_VECTORSCORES_H
+
+#include "VectorStore.h"
+
+// how a vector is scored against a query.
+typedef enum ScoreType
+{
+	DOT_SCORE, // the dot product of the vector and the query.
+	COSINE_SCORE // the cosine of the angle between them, 0 if one of them is all zeros.
+} ScoreType;
+
+/**
+ * scores an array of vectors against a query, in one pass over the vectors. the vectors are split
+ * to nThreads contiguous parts, each scored by its own thread with the SIMD dot product kernel.
+ * the coefficients a vector has and the query hasn't (or the other way around) count as zeros.
+ * cosine scores use the cached norms of the vectors, so they must be set up with initVector. every
+ * vector is scored by a single thread so the norms are cached without races.
+ * @param vectors: array of pointers to vectors.
+ * @param n: number of vectors.
+ * @param q: the query.
+ * @param type: how to score.
+ * @param scores: array of n doubles, scores[i] will be the score of vectors[i].
+ * @param nThreads: number of threads to use, if a thread can't be started its part is scored by
+ * the caller.
+ * @return: 0 on failure, other on success.
+ */
+int scoreVectors(Vector *const *vectors, int n, const Vector *q, ScoreType type, double *scores,
+				 int nThreads);
+
+/**
+ * scores all the vectors of a tree against a query, see scoreVectors.
+ * @param tree: a tree of Vectors.
+ * @param q: the query.
+ * @param type: how to score.
+ * @param scores: array of tree->size doubles, will be filled in the ascending order of the tree.
+ * @param nThreads: number of threads to use.
+ * @return: 0 on failure, other on success.
+ */
+int scoreRBTree(RBTree *tree, const Vector *q, ScoreType type, double *scores, int nThreads);
+
+/**
+ * scores all the vectors of a store against a query, see scoreVectors.
+ * @param store: a store of Vectors.
+ * @param q: the query.
+ * @param type: how to score.
+ * @param scores: array of store->size doubles, will be filled in the order the vectors were added.
+ * @param nThreads: number of threads to use.
+ * @return: 0 on failure, other on success.
+ */
+int scoreVectorStore(VectorStore *store, const Vector *q, ScoreType type, double *scores,
+					 int nThreads);
+
+#endif //TA_EX3_VECTORSCORES_H
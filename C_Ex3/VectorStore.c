@@ -0,0 +1,132 @@
+#include "VectorStore.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @param len - number of coefficients.
+ * @return bytes taken in a slab by a Vector with len coefficients, a multiple of sizeof(double).
+ */
+size_t getStoreEntrySize(int len)
+{
+    size_t headerSize = (sizeof(Vector) + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    return headerSize + (size_t) len * sizeof(double);
+}
+
+VectorStore *newVectorStore(size_t slabSize)
+{
+    VectorStore *store = (VectorStore *) malloc(sizeof(VectorStore));
+    if (store == NULL)
+    {
+        return NULL;
+    }
+    store->first = NULL;
+    store->last = NULL;
+    store->slabSize = (slabSize == 0) ? DEFAULT_SLAB_SIZE : slabSize;
+    store->size = 0;
+    return store;
+}
+
+/**
+ * adds an empty slab after the last slab of the store.
+ * @param store - VectorStore.
+ * @param capacity - bytes of data in the new slab.
+ * @return 0 on failure, other on success.
+ */
+int addVectorSlab(VectorStore *store, size_t capacity)
+{
+    VectorSlab *slab = (VectorSlab *) malloc(sizeof(VectorSlab) + capacity);
+    if (slab == NULL)
+    {
+        return 0;
+    }
+    slab->next = NULL;
+    slab->used = 0;
+    slab->capacity = capacity;
+    if (store->last == NULL)
+    {
+        store->first = slab;
+    }
+    else
+    {
+        store->last->next = slab;
+    }
+    store->last = slab;
+    return 1;
+}
+
+Vector *newVectorInStore(VectorStore *store, int len)
+{
+    if (store == NULL || len < 0)
+    {
+        return NULL;
+    }
+    size_t entrySize = getStoreEntrySize(len);
+    // the rest of a slab that is too small is left unused, the slabs are filled in order.
+    if (store->last == NULL || store->last->capacity - store->last->used < entrySize)
+    {
+        size_t capacity = (entrySize > store->slabSize) ? entrySize : store->slabSize;
+        if (addVectorSlab(store, capacity) == 0)
+        {
+            return NULL;
+        }
+    }
+    VectorSlab *slab = store->last;
+    Vector *v = (Vector *) ((char *) slab->data + slab->used);
+    initVector(v, (double *) ((char *) v + getStoreEntrySize(0)), len);
+    slab->used += entrySize;
+    store->size++;
+    return v;
+}
+
+Vector *addToVectorStore(VectorStore *store, const double *coefficients, int len)
+{
+    Vector *v = newVectorInStore(store, len);
+    if (v != NULL)
+    {
+        memcpy(v->vector, coefficients, (size_t) len * sizeof(double));
+    }
+    return v;
+}
+
+int forEachVectorStore(VectorStore *store, forEachFunc func, void *args)
+{
+    if (store == NULL || func == NULL)
+    {
+        return 0;
+    }
+    for (VectorSlab *slab = store->first; slab != NULL; slab = slab->next)
+    {
+        size_t offset = 0;
+        while (offset < slab->used)
+        {
+            Vector *v = (Vector *) ((char *) slab->data + offset);
+            if (func(v, args) == 0)
+            {
+                return 0;
+            }
+            offset += getStoreEntrySize(v->len);
+        }
+    }
+    return 1;
+}
+
+void freeStoreVector(void *pVector)
+{
+    (void) pVector;
+}
+
+void freeVectorStore(VectorStore *store)
+{
+    if (store == NULL)
+    {
+        return;
+    }
+    VectorSlab *slab = store->first;
+    while (slab != NULL)
+    {
+        VectorSlab *next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    free(store);
+}
@@ -0,0 +1,81 @@
+#ifndef TA_EX3_VECTORSTORE_H
+#define TA_EX3_VECTORSTORE_H
+
+#include "Structs.h"
+
+#define DEFAULT_SLAB_SIZE (1 << 20) // bytes in a slab of a VectorStore.
+
+/*
+ * a large block of memory of a VectorStore, holds Vectors and their coefficients back to back.
+ */
+typedef struct VectorSlab
+{
+	struct VectorSlab *next;
+	size_t used; // bytes of data in use.
+	size_t capacity; // bytes of data.
+	double data[]; // entries of a Vector followed by its coefficients, aligned for doubles.
+} VectorSlab;
+
+/**
+ * an arena of Vectors: every Vector is stored right before its coefficients, in large slabs that
+ * are filled in order, so a million vectors take a few allocations and are scanned sequentially.
+ * the vectors must not be freed with freeVector: a tree of them takes freeStoreVector as its
+ * FreeFunc, and all of them are released with the store.
+ */
+typedef struct VectorStore
+{
+	VectorSlab *first;
+	VectorSlab *last; // the slab new vectors are added to.
+	size_t slabSize;
+	int size;
+} VectorStore;
+
+/**
+ * constructs a new, empty, VectorStore.
+ * @param slabSize: bytes in a slab, 0 for DEFAULT_SLAB_SIZE. larger vectors get a slab of their own.
+ * @return: the new store, NULL on failure.
+ */
+VectorStore *newVectorStore(size_t slabSize);
+
+/**
+ * adds a vector with uninitialized coefficients to the store, to be filled by the caller (and
+ * no cached norm).
+ * @param store: the store to add the vector to.
+ * @param len: number of coefficients.
+ * @return: the new vector, valid until the store is freed. NULL on failure.
+ */
+Vector *newVectorInStore(VectorStore *store, int len);
+
+/**
+ * adds a copy of the given coefficients to the store as a vector.
+ * @param store: the store to add the vector to.
+ * @param coefficients: array of len doubles.
+ * @param len: number of coefficients.
+ * @return: the new vector, valid until the store is freed. NULL on failure.
+ */
+Vector *addToVectorStore(VectorStore *store, const double *coefficients, int len);
+
+/**
+ * Activate a function on each vector of the store, in the order they were added. if one of the
+ * activations of the function returns 0, the process stops.
+ * @param store: the store with all the vectors.
+ * @param func: the function to activate on all vectors.
+ * @param args: more optional arguments to the function (may be null if the given function support it).
+ * @return: 0 on failure, other on success.
+ */
+int forEachVectorStore(VectorStore *store, forEachFunc func, void *args);
+
+/**
+ * FreeFunc for trees of vectors of a VectorStore, does nothing: the vectors are released with
+ * their store.
+ * @param pVector: a vector of a VectorStore.
+ */
+void freeStoreVector(void *pVector);
+
+/**
+ * free all memory of the store, including all of its vectors.
+ * @param store: the store to free.
+ */
+void freeVectorStore(VectorStore *store);
+
+#endif //TA_EX3_VECTORSTORE_H
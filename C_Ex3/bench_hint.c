@@ -0,0 +1,181 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "RBTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_KEYS 1000000
+#define NUM_RUNS 3 // the fastest run is reported.
+#define SWAP_WINDOW 8 // nearly sorted keys move at most this far from their sorted place.
+
+// comparisons made by countingCompare.
+long long numComparisons = 0;
+
+/**
+ * the ways to add the keys to a tree.
+ */
+typedef enum InsertMethod
+{
+    PLAIN_INSERT, // addToRBTree, with its append fast path.
+    HINT_INSERT, // addToRBTreeHint with lastAdded as the hint.
+    SORTED_BUILD // addSortedToRBTree, for sorted keys only.
+} InsertMethod;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * CompareFunc for ints that counts its calls.
+ */
+int countingCompare(const void *a, const void *b)
+{
+    numComparisons++;
+    int first = *(const int *) a;
+    int second = *(const int *) b;
+    return (first > second) - (first < second);
+}
+
+/**
+ * ForEach function that checks the keys are reached in ascending order.
+ * @param key - int*
+ * @param pPrev - const int** with the previous key, NULL before the first one.
+ * @return 0 if key isn't larger than the previous key, 1 otherwise.
+ */
+int checkAscending(const void *key, void *pPrev)
+{
+    const int **prev = (const int **) pPrev;
+    if (*prev != NULL && **prev >= *(const int *) key)
+    {
+        return 0;
+    }
+    *prev = (const int *) key;
+    return 1;
+}
+
+/**
+ * fills the keys of an input: 0 sorted, 1 nearly sorted (sorted, then keys swapped with a random
+ * key up to SWAP_WINDOW places after them, a quarter of the keys that weren't swapped yet),
+ * 2 random order, 3 descending.
+ * @param keys - NUM_KEYS distinct values.
+ * @param items - will hold pointers to the keys in the order of the input.
+ */
+void makeInput(int input, int *keys, void **items)
+{
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = 2 * i;
+        items[i] = &keys[(input == 3) ? NUM_KEYS - 1 - i : i];
+    }
+    for (int i = 0; input == 1 && i + SWAP_WINDOW < NUM_KEYS; i++)
+    {
+        if (rand() % 4 == 0)
+        {
+            int j = i + 1 + rand() % SWAP_WINDOW;
+            void *tmp = items[i];
+            items[i] = items[j];
+            items[j] = tmp;
+            i = j; // every key is moved at most once.
+        }
+    }
+    for (int i = NUM_KEYS - 1; input == 2 && i > 0; i--)
+    {
+        int j = rand() % (i + 1);
+        void *tmp = items[i];
+        items[i] = items[j];
+        items[j] = tmp;
+    }
+}
+
+/**
+ * times building a tree of the items with the given method.
+ * @param comparisons - will hold the comparisons per key.
+ * @param valid - will hold 0 if the tree doesn't hold all the keys in order.
+ * @return the fastest time of a run, in seconds.
+ */
+double timeInsert(void **items, InsertMethod method, double *comparisons, int *valid)
+{
+    double best = 0;
+    *valid = 1;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        RBTree *tree = newRBTree(countingCompare, NULL);
+        if (tree == NULL)
+        {
+            *valid = 0;
+            return 0;
+        }
+        numComparisons = 0;
+        double start = benchNow();
+        if (method == SORTED_BUILD)
+        {
+            *valid &= addSortedToRBTree(tree, items, NUM_KEYS);
+        }
+        for (int i = 0; method != SORTED_BUILD && i < NUM_KEYS; i++)
+        {
+            *valid &= (method == HINT_INSERT) ? addToRBTreeHint(tree, items[i], tree->lastAdded)
+                                              : addToRBTree(tree, items[i]);
+        }
+        double elapsed = benchNow() - start;
+        *comparisons = (double) numComparisons / NUM_KEYS;
+        const int *prev = NULL;
+        *valid &= (tree->size == NUM_KEYS && forEachRBTree(tree, checkAscending, &prev));
+        freeRBTree(tree);
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/**
+ * prints the comparisons per key and the time of building a tree of int keys with addToRBTree,
+ * with addToRBTreeHint next to the last added key, and (for sorted keys) with addSortedToRBTree,
+ * on sorted, nearly sorted, random and descending keys. the random keys show the cost of a
+ * descent from the root, the descending keys the cost of a failed append check before it.
+ */
+int main()
+{
+    const char *inputs[] = {"sorted", "nearly", "random", "descending"};
+    const char *methods[] = {"addToRBTree", "hint lastAdded", "addSorted"};
+    int *keys = (int *) malloc(NUM_KEYS * sizeof(int));
+    void **items = (void **) malloc(NUM_KEYS * sizeof(void *));
+    if (keys == NULL || items == NULL)
+    {
+        free(keys);
+        free(items);
+        return EXIT_FAILURE;
+    }
+    int invalid = 0;
+    srand(29);
+
+    printf("%d int keys\n%-11s %-15s %10s %10s\n", NUM_KEYS, "input", "method", "cmp/key", "ms");
+    for (int input = 0; input < 4; input++)
+    {
+        makeInput(input, keys, items);
+        for (int method = PLAIN_INSERT; method <= SORTED_BUILD; method++)
+        {
+            if (method == SORTED_BUILD && input != 0)
+            {
+                continue;
+            }
+            double comparisons;
+            int valid;
+            double elapsed = timeInsert(items, (InsertMethod) method, &comparisons, &valid);
+            invalid += !valid;
+            printf("%-11s %-15s %10.2f %10.1f\n", inputs[input], methods[method], comparisons,
+                   elapsed * 1e3);
+        }
+    }
+    free(keys);
+    free(items);
+    printf("%d invalid trees\n", invalid);
+    return invalid == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
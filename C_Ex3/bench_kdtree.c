@@ -0,0 +1,154 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "KDTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_POINTS 100000
+#define NUM_QUERIES 200
+#define MAX_K 50
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * @return a uniform random number in [0, 1).
+ */
+double randomUnit()
+{
+    return (double) rand() / ((double) RAND_MAX + 1);
+}
+
+/**
+ * allocates n random vectors of the given dimension, uniform in the unit cube.
+ * @return the array of pointers, NULL on failure.
+ */
+Vector **newRandomVectors(int n, int dim)
+{
+    Vector **vectors = (Vector **) malloc(n * sizeof(Vector *));
+    double *coefficients = (double *) malloc((size_t) n * dim * sizeof(double));
+    Vector *structs = (Vector *) malloc(n * sizeof(Vector));
+    if (vectors == NULL || coefficients == NULL || structs == NULL)
+    {
+        free(vectors);
+        free(coefficients);
+        free(structs);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < dim; j++)
+        {
+            coefficients[(size_t) i * dim + j] = randomUnit();
+        }
+        initVector(&structs[i], &coefficients[(size_t) i * dim], dim);
+        vectors[i] = &structs[i];
+    }
+    return vectors;
+}
+
+/**
+ * frees vectors allocated by newRandomVectors.
+ */
+void freeRandomVectors(Vector **vectors)
+{
+    free(vectors[0]->vector);
+    free(vectors[0]);
+    free(vectors);
+}
+
+/**
+ * finds the squared distances of the k points closest to q by scanning all of them, keeping the
+ * best k in a sorted array.
+ * @param sqrDistances - will hold the k smallest squared distances in ascending order.
+ */
+void bruteForceKnn(Vector *const *points, int n, const Vector *q, int k, double *sqrDistances)
+{
+    int found = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double dist = 0;
+        for (int j = 0; j < q->len; j++)
+        {
+            double diff = points[i]->vector[j] - q->vector[j];
+            dist += diff * diff;
+        }
+        if (found == k && dist >= sqrDistances[k - 1])
+        {
+            continue;
+        }
+        int pos = (found < k) ? found++ : k - 1;
+        while (pos > 0 && sqrDistances[pos - 1] > dist)
+        {
+            sqrDistances[pos] = sqrDistances[pos - 1];
+            pos--;
+        }
+        sqrDistances[pos] = dist;
+    }
+}
+
+/**
+ * compares knnSearch with a brute force scan over random points, in several dimensions (including
+ * the dimensions in which the KD tree falls back to a scan) and for several k. the k-th distance
+ * of both is checked to be the same.
+ */
+int main()
+{
+    const int dims[] = {2, 3, 5, 8, 10, 16};
+    const int ks[] = {1, 10, MAX_K};
+    const Vector *neighbours[MAX_K];
+    double kdDistances[MAX_K], bruteDistances[MAX_K];
+    int mismatches = 0;
+    srand(41);
+
+    printf("%d points, %d queries, ms per query\n", NUM_POINTS, NUM_QUERIES);
+    printf("%4s %4s %10s %10s %10s %8s\n", "dim", "k", "build", "kd tree", "brute", "speedup");
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++)
+    {
+        Vector **points = newRandomVectors(NUM_POINTS, dims[d]);
+        Vector **queries = newRandomVectors(NUM_QUERIES, dims[d]);
+        if (points == NULL || queries == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        double start = benchNow();
+        KDTree *index = newKDTree(points, NUM_POINTS);
+        double build = benchNow() - start;
+        if (index == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        for (size_t kIdx = 0; kIdx < sizeof(ks) / sizeof(ks[0]); kIdx++)
+        {
+            int k = ks[kIdx];
+            double kdTime = 0, bruteTime = 0;
+            for (int i = 0; i < NUM_QUERIES; i++)
+            {
+                start = benchNow();
+                knnSearch(index, queries[i], k, neighbours, kdDistances);
+                kdTime += benchNow() - start;
+                start = benchNow();
+                bruteForceKnn(points, NUM_POINTS, queries[i], k, bruteDistances);
+                bruteTime += benchNow() - start;
+                if (kdDistances[k - 1] != bruteDistances[k - 1])
+                {
+                    mismatches++;
+                }
+            }
+            printf("%4d %4d %8.1fms %10.4f %10.4f %7.1fx\n", dims[d], k, build * 1e3,
+                   kdTime * 1e3 / NUM_QUERIES, bruteTime * 1e3 / NUM_QUERIES, bruteTime / kdTime);
+        }
+        freeKDTree(index);
+        freeRandomVectors(points);
+        freeRandomVectors(queries);
+    }
+    printf("%d mismatches against brute force\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
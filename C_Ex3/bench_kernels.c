@@ -0,0 +1,152 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "VectorKernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define MIN_DIM 4
+#define MAX_DIM 4096
+#define DOUBLES_PER_RUN (1 << 24) // every kernel reads about as many doubles at every dimension.
+#define NUM_RUNS 3 // the fastest run is reported.
+
+// the kernels of every instruction set, defined in VectorKernels.c.
+int compareDoublesScalar(const double *a, const double *b, int len);
+double sumOfSquaresScalar(const double *a, int len);
+double dotProductScalar(const double *a, const double *b, int len);
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BENCH_KERNELS_X86
+int compareDoublesSSE2(const double *a, const double *b, int len);
+double sumOfSquaresSSE2(const double *a, int len);
+double dotProductSSE2(const double *a, const double *b, int len);
+int compareDoublesAVX2(const double *a, const double *b, int len);
+double sumOfSquaresAVX2(const double *a, int len);
+double dotProductAVX2(const double *a, const double *b, int len);
+#endif
+
+/**
+ * the kernels of a single instruction set.
+ */
+typedef struct KernelSet
+{
+    const char *name;
+    int (*compare)(const double *a, const double *b, int len);
+    double (*norm)(const double *a, int len);
+    double (*dot)(const double *a, const double *b, int len);
+} KernelSet;
+
+// keeps the results alive, so the calls aren't optimized away.
+volatile double benchSink;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * times a kernel on two equal vectors, so compare has to read them to the end.
+ * @param set - the kernels.
+ * @param kernel - 0 for compare, 1 for norm, 2 for dot product.
+ * @param a - first vector.
+ * @param b - second vector, equal to a.
+ * @param dim - length of the vectors.
+ * @return the fastest time of a single call, in nanoseconds.
+ */
+double timeKernel(const KernelSet *set, int kernel, const double *a, const double *b, int dim)
+{
+    int calls = DOUBLES_PER_RUN / dim;
+    double best = 0;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        double sum = 0;
+        double start = benchNow();
+        for (int i = 0; i < calls; i++)
+        {
+            if (kernel == 0)
+            {
+                sum += set->compare(a, b, dim);
+            }
+            else if (kernel == 1)
+            {
+                sum += set->norm(a, dim);
+            }
+            else
+            {
+                sum += set->dot(a, b, dim);
+            }
+        }
+        double elapsed = benchNow() - start;
+        benchSink = sum;
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best * 1e9 / calls;
+}
+
+/**
+ * sweeps the dimensions 4 to 4096 for every instruction set the cpu supports, and prints the
+ * time of a call to every kernel.
+ */
+int main()
+{
+    KernelSet sets[4];
+    int numSets = 0;
+    sets[numSets++] = (KernelSet) {"scalar", compareDoublesScalar, sumOfSquaresScalar,
+                                   dotProductScalar};
+#ifdef BENCH_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+    {
+        sets[numSets++] = (KernelSet) {"sse2", compareDoublesSSE2, sumOfSquaresSSE2,
+                                       dotProductSSE2};
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        sets[numSets++] = (KernelSet) {"avx2", compareDoublesAVX2, sumOfSquaresAVX2,
+                                       dotProductAVX2};
+    }
+#endif
+    sets[numSets++] = (KernelSet) {"dispatch", compareDoubles, sumOfSquares, dotProduct};
+
+    double *a = (double *) malloc(sizeof(double) * MAX_DIM);
+    double *b = (double *) malloc(sizeof(double) * MAX_DIM);
+    if (a == NULL || b == NULL)
+    {
+        free(a);
+        free(b);
+        return EXIT_FAILURE;
+    }
+    for (int i = 0; i < MAX_DIM; i++)
+    {
+        a[i] = b[i] = (double) (i % 17) - 8.5;
+    }
+
+    const char *kernels[] = {"compare", "norm", "dot"};
+    printf("ns per call\n%-8s %6s", "kernel", "dim");
+    for (int s = 0; s < numSets; s++)
+    {
+        printf(" %10s", sets[s].name);
+    }
+    printf("\n");
+    for (int kernel = 0; kernel < 3; kernel++)
+    {
+        for (int dim = MIN_DIM; dim <= MAX_DIM; dim *= 2)
+        {
+            printf("%-8s %6d", kernels[kernel], dim);
+            for (int s = 0; s < numSets; s++)
+            {
+                printf(" %10.1f", timeKernel(&sets[s], kernel, a, b, dim));
+            }
+            printf("\n");
+        }
+    }
+    free(a);
+    free(b);
+    return EXIT_SUCCESS;
+}
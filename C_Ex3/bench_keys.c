@@ -0,0 +1,198 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "RBTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NUM_RECORDS 1000000
+#define NUM_LOOKUPS 3000000
+#define NUM_RUNS 3 // the fastest run is reported.
+
+/**
+ * a 64 byte record, the trees are ordered by its id.
+ */
+typedef struct Record
+{
+    int64_t id;
+    double score; // the id as a double, the key of the double key tree.
+    char payload[48];
+} Record;
+
+/**
+ * the ways to order the records.
+ */
+typedef enum TreeKind
+{
+    GENERIC_TREE, // newRBTree with a CompareFunc that reads the ids.
+    INT_TREE, // newIntKeyRBTree.
+    DOUBLE_TREE // newDoubleKeyRBTree.
+} TreeKind;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * CompareFunc for Records, by id.
+ */
+int recordCompare(const void *a, const void *b)
+{
+    int64_t first = ((const Record *) a)->id;
+    int64_t second = ((const Record *) b)->id;
+    return (first > second) - (first < second);
+}
+
+/**
+ * IntKeyFunc of Records.
+ */
+int64_t getRecordId(const void *record)
+{
+    return ((const Record *) record)->id;
+}
+
+/**
+ * DoubleKeyFunc of Records.
+ */
+double getRecordScore(const void *record)
+{
+    return ((const Record *) record)->score;
+}
+
+/**
+ * @return a random 53 bit number, a double holds it exactly.
+ */
+int64_t randomId()
+{
+    int64_t id = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        id = (id << 15) | (rand() & 0x7FFF);
+    }
+    return id >> 7;
+}
+
+/**
+ * @return a new empty tree of the given kind, NULL on failure.
+ */
+RBTree *newRecordTree(TreeKind kind)
+{
+    switch (kind)
+    {
+        case INT_TREE:
+            return newIntKeyRBTree(getRecordId, NULL);
+        case DOUBLE_TREE:
+            return newDoubleKeyRBTree(getRecordScore, NULL);
+        default:
+            return newRBTree(recordCompare, NULL);
+    }
+}
+
+/**
+ * times adding all the records to a tree of the given kind, and looking up the probes in it.
+ * @param probes - NUM_LOOKUPS records, about half of them in the tree.
+ * @param insertTime - will hold the fastest insertion time, in seconds.
+ * @param lookupTime - will hold the fastest lookup time, in seconds.
+ * @param found - will hold the number of probes found and the size of the tree.
+ * @return 0 on failure, other on success.
+ */
+int timeTree(TreeKind kind, Record *records, Record *const *probes, double *insertTime,
+             double *lookupTime, long *found)
+{
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        RBTree *tree = newRecordTree(kind);
+        if (tree == NULL)
+        {
+            return 0;
+        }
+        double start = benchNow();
+        for (int i = 0; i < NUM_RECORDS; i++)
+        {
+            addToRBTree(tree, &records[i]);
+        }
+        double middle = benchNow();
+        long count = tree->size;
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            count += containsRBTree(tree, probes[i]);
+        }
+        double end = benchNow();
+        freeRBTree(tree);
+        if (run == 0 || middle - start < *insertTime)
+        {
+            *insertTime = middle - start;
+        }
+        if (run == 0 || end - middle < *lookupTime)
+        {
+            *lookupTime = end - middle;
+        }
+        *found = count;
+    }
+    return 1;
+}
+
+/**
+ * prints the insertion and lookup times of trees of 64 byte records ordered by an int64 id: with
+ * a generic CompareFunc that reads the records, and with the id (and the id as a double) cached
+ * after every node. the bytes of a node are printed as well, the node and its cached key.
+ * @return 0 if all the trees found the same records, 1 otherwise.
+ */
+int main()
+{
+    const char *kinds[] = {"generic", "int key", "double key"};
+    Record *records = (Record *) malloc(NUM_RECORDS * sizeof(Record));
+    Record *missing = (Record *) malloc(NUM_RECORDS * sizeof(Record));
+    Record **probes = (Record **) malloc(NUM_LOOKUPS * sizeof(Record *));
+    if (records == NULL || missing == NULL || probes == NULL)
+    {
+        free(records);
+        free(missing);
+        free(probes);
+        return EXIT_FAILURE;
+    }
+    srand(31);
+    for (int i = 0; i < NUM_RECORDS; i++)
+    {
+        records[i].id = randomId();
+        records[i].score = (double) records[i].id;
+        missing[i].id = randomId();
+        missing[i].score = (double) missing[i].id;
+    }
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        probes[i] = (i % 2 == 0) ? &records[rand() % NUM_RECORDS] : &missing[rand() % NUM_RECORDS];
+    }
+
+    int mismatches = 0;
+    long expected = 0;
+    printf("%d records, %d lookups\n%-11s %10s %10s %12s\n", NUM_RECORDS, NUM_LOOKUPS, "tree",
+           "node bytes", "insert ms", "lookups ms");
+    for (int kind = GENERIC_TREE; kind <= DOUBLE_TREE; kind++)
+    {
+        double insertTime = 0, lookupTime = 0;
+        long found = 0;
+        RBTree *empty = newRecordTree((TreeKind) kind);
+        if (empty == NULL || !timeTree((TreeKind) kind, records, probes, &insertTime, &lookupTime,
+                                       &found))
+        {
+            freeRBTree(empty);
+            return EXIT_FAILURE;
+        }
+        mismatches += (kind != GENERIC_TREE && found != expected);
+        expected = found;
+        printf("%-11s %10zu %10.1f %12.1f\n", kinds[kind], sizeof(Node) + empty->keySize,
+               insertTime * 1e3, lookupTime * 1e3);
+        freeRBTree(empty);
+    }
+    free(records);
+    free(missing);
+    free(probes);
+    printf("%d mismatches against the generic tree\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,234 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "RBTree.h"
+#include "RadixTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_KEYS 1000000
+#define NUM_LOOKUPS 1000000
+#define NUM_RUNS 3 // the fastest run is reported.
+#define MAX_KEY_LEN 64
+#define NUM_HOSTS 4
+#define NUM_CATEGORIES 1000
+
+/**
+ * the memory a structure asked malloc for, the overhead of malloc itself isn't included.
+ */
+typedef struct Footprint
+{
+    size_t bytes;
+    long allocations;
+} Footprint;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * writes the URL of an item, "https://www.site<host>.com/cat/<category>/item/<item>" with a
+ * random host and category, so all the URLs share their first 16 bytes and the URLs of a host
+ * share 26.
+ * @param key - buffer of MAX_KEY_LEN chars.
+ */
+void makeUrl(char *key, int item)
+{
+    snprintf(key, MAX_KEY_LEN, "https://www.site%d.com/cat/%d/item/%d", rand() % NUM_HOSTS,
+             rand() % NUM_CATEGORIES, item);
+}
+
+/**
+ * ForEach function of a string RBTree that adds the bytes of every string to a Footprint.
+ */
+int addStringFootprint(const void *str, void *pFootprint)
+{
+    Footprint *footprint = (Footprint *) pFootprint;
+    footprint->bytes += strlen((const char *) str) + 1;
+    footprint->allocations++;
+    return 1;
+}
+
+/**
+ * adds the bytes of a radix node and of all the nodes below it to a Footprint.
+ */
+void addRadixFootprint(const RadixNode *node, Footprint *footprint)
+{
+    footprint->bytes += sizeof(RadixNode) + node->labelLen;
+    footprint->allocations++;
+    if (node->capacity > 0)
+    {
+        footprint->bytes += node->capacity * (sizeof(RadixNode *) + 1);
+        footprint->allocations++;
+    }
+    for (int i = 0; i < node->nChildren; i++)
+    {
+        addRadixFootprint(node->children[i], footprint);
+    }
+}
+
+/**
+ * builds a newStringRBTree that owns a copy of every key, as a set of strings must.
+ * @return the tree, NULL on failure.
+ */
+RBTree *buildRBTree(char *const *keys)
+{
+    RBTree *tree = newStringRBTree(free);
+    for (int i = 0; tree != NULL && i < NUM_KEYS; i++)
+    {
+        char *copy = (char *) malloc(strlen(keys[i]) + 1);
+        if (copy == NULL)
+        {
+            freeRBTree(tree);
+            return NULL;
+        }
+        strcpy(copy, keys[i]);
+        if (!addToRBTree(tree, copy))
+        {
+            free(copy);
+        }
+    }
+    return tree;
+}
+
+/**
+ * builds a RadixTree of the keys.
+ * @return the tree, NULL on failure.
+ */
+RadixTree *buildRadixTree(char *const *keys)
+{
+    RadixTree *tree = newRadixTree();
+    for (int i = 0; tree != NULL && i < NUM_KEYS; i++)
+    {
+        addToRadixTree(tree, keys[i]);
+    }
+    return tree;
+}
+
+/**
+ * times building a set of the keys and looking up the probes in it, and measures its memory.
+ * @param radix - 0 for a newStringRBTree, other for a RadixTree.
+ * @param probes - NUM_LOOKUPS strings, about half of them in the set.
+ * @param insertTime - will hold the fastest build time, in seconds.
+ * @param lookupTime - will hold the fastest lookup time, in seconds.
+ * @param footprint - will hold the memory of the set.
+ * @param found - will hold the number of probes found and the size of the set.
+ * @return 0 on failure, other on success.
+ */
+int timeSet(int radix, char *const *keys, char *const *probes, double *insertTime,
+            double *lookupTime, Footprint *footprint, long *found)
+{
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        double start = benchNow();
+        RBTree *rbTree = radix ? NULL : buildRBTree(keys);
+        RadixTree *radixTree = radix ? buildRadixTree(keys) : NULL;
+        double middle = benchNow();
+        if (rbTree == NULL && radixTree == NULL)
+        {
+            return 0;
+        }
+        long count = radix ? radixTree->size : rbTree->size;
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            count += radix ? containsRadixTree(radixTree, probes[i])
+                           : containsRBTree(rbTree, probes[i]);
+        }
+        double end = benchNow();
+        footprint->bytes = 0;
+        footprint->allocations = 0;
+        if (radix)
+        {
+            addRadixFootprint(radixTree->root, footprint);
+            footprint->bytes += sizeof(RadixTree);
+        }
+        else
+        {
+            forEachRBTree(rbTree, addStringFootprint, footprint);
+            footprint->bytes += sizeof(RBTree) + rbTree->size * (sizeof(Node) + rbTree->keySize);
+            footprint->allocations += rbTree->size;
+        }
+        footprint->allocations++;
+        freeRBTree(rbTree);
+        freeRadixTree(radixTree);
+        if (run == 0 || middle - start < *insertTime)
+        {
+            *insertTime = middle - start;
+        }
+        if (run == 0 || end - middle < *lookupTime)
+        {
+            *lookupTime = end - middle;
+        }
+        *found = count;
+    }
+    return 1;
+}
+
+/**
+ * prints the memory, build time and lookup time of a set of URL-like strings kept in a RadixTree
+ * and in a newStringRBTree that owns a copy of every string. the memory is what the structures
+ * asked malloc for, every allocation costs malloc about 8 to 16 more bytes.
+ * @return 0 if both sets found the same strings, 1 otherwise.
+ */
+int main()
+{
+    const char *sets[] = {"RBTree", "RadixTree"};
+    char *buffer = (char *) malloc((size_t) 2 * NUM_KEYS * MAX_KEY_LEN);
+    char **keys = (char **) malloc(NUM_KEYS * sizeof(char *));
+    char **probes = (char **) malloc(NUM_LOOKUPS * sizeof(char *));
+    if (buffer == NULL || keys == NULL || probes == NULL)
+    {
+        free(buffer);
+        free(keys);
+        free(probes);
+        return EXIT_FAILURE;
+    }
+    srand(33);
+    size_t keyBytes = 0;
+    for (int i = 0; i < 2 * NUM_KEYS; i++) // the second half are probes that are missing.
+    {
+        makeUrl(buffer + (size_t) i * MAX_KEY_LEN, i);
+    }
+    for (int i = 0; i < NUM_KEYS; i++)
+    {
+        keys[i] = buffer + (size_t) i * MAX_KEY_LEN;
+        keyBytes += strlen(keys[i]) + 1;
+    }
+    for (int i = 0; i < NUM_LOOKUPS; i++)
+    {
+        probes[i] = buffer + (size_t) (rand() % (2 * NUM_KEYS)) * MAX_KEY_LEN;
+    }
+
+    int mismatches = 0;
+    long expected = 0;
+    printf("%d URLs of %.1f MB, %d lookups\n%-10s %8s %12s %10s %12s\n", NUM_KEYS, keyBytes * 1e-6,
+           NUM_LOOKUPS, "set", "MB", "allocations", "insert ms", "lookups ms");
+    for (int radix = 0; radix <= 1; radix++)
+    {
+        double insertTime = 0, lookupTime = 0;
+        Footprint footprint = {0, 0};
+        long found = 0;
+        if (!timeSet(radix, keys, probes, &insertTime, &lookupTime, &footprint, &found))
+        {
+            free(buffer);
+            free(keys);
+            free(probes);
+            return EXIT_FAILURE;
+        }
+        mismatches += (radix && found != expected);
+        expected = found;
+        printf("%-10s %8.1f %12ld %10.1f %12.1f\n", sets[radix], footprint.bytes * 1e-6,
+               footprint.allocations, insertTime * 1e3, lookupTime * 1e3);
+    }
+    free(buffer);
+    free(keys);
+    free(probes);
+    printf("%d mismatches against the RBTree\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,226 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "ReducedVector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define NUM_VECTORS 20000
+#define NUM_RUNS 3 // the fastest run is reported.
+
+// keeps the results alive, so the calls aren't optimized away.
+volatile double benchSink;
+
+/**
+ * the same vectors as doubles, floats and int8.
+ */
+typedef struct ReducedSet
+{
+    Vector **dense;
+    FloatVector **floats;
+    QuantizedVector **quantized;
+} ReducedSet;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * frees the vectors of a set, the ones that were allocated.
+ */
+void freeReducedSet(ReducedSet *set)
+{
+    for (int i = 0; i < NUM_VECTORS; i++)
+    {
+        if (set->dense != NULL && set->dense[i] != NULL)
+        {
+            freeVector(set->dense[i]);
+        }
+        if (set->floats != NULL && set->floats[i] != NULL)
+        {
+            freeFloatVector(set->floats[i]);
+        }
+        if (set->quantized != NULL && set->quantized[i] != NULL)
+        {
+            freeQuantizedVector(set->quantized[i]);
+        }
+    }
+    free(set->dense);
+    free(set->floats);
+    free(set->quantized);
+}
+
+/**
+ * fills a set with NUM_VECTORS random vectors of the given dimension. the coefficients are
+ * gaussian-like, a sum of uniform numbers, so few of them are near the largest one of a vector.
+ * @return 0 on failure, other on success.
+ */
+int newReducedSet(ReducedSet *set, int dim)
+{
+    set->dense = (Vector **) calloc(NUM_VECTORS, sizeof(Vector *));
+    set->floats = (FloatVector **) calloc(NUM_VECTORS, sizeof(FloatVector *));
+    set->quantized = (QuantizedVector **) calloc(NUM_VECTORS, sizeof(QuantizedVector *));
+    if (set->dense == NULL || set->floats == NULL || set->quantized == NULL)
+    {
+        freeReducedSet(set);
+        return 0;
+    }
+    for (int i = 0; i < NUM_VECTORS; i++)
+    {
+        Vector *v = (Vector *) malloc(sizeof(Vector));
+        double *coefficients = (double *) malloc(dim * sizeof(double));
+        if (v == NULL || coefficients == NULL)
+        {
+            free(v);
+            free(coefficients);
+            freeReducedSet(set);
+            return 0;
+        }
+        for (int j = 0; j < dim; j++)
+        {
+            coefficients[j] = 0;
+            for (int u = 0; u < 4; u++)
+            {
+                coefficients[j] += (double) rand() / RAND_MAX - 0.5;
+            }
+        }
+        initVector(v, coefficients, dim);
+        set->dense[i] = v;
+        set->floats[i] = denseToFloatVector(v);
+        set->quantized[i] = denseToQuantizedVector(v);
+        if (set->floats[i] == NULL || set->quantized[i] == NULL)
+        {
+            freeReducedSet(set);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * prints the largest relative error of the squared norms and of the dot products of neighbouring
+ * vectors, of the float and int8 vectors against the doubles they were made of. the dot products
+ * of the reduced vectors are summed in doubles, so only the rounding of the coefficients counts.
+ */
+void printReducedErrors(const ReducedSet *set, int dim)
+{
+    double normError[2] = {0, 0}, dotError[2] = {0, 0};
+    for (int i = 0; i < NUM_VECTORS; i++)
+    {
+        const Vector *v = set->dense[i], *w = set->dense[(i + 1) % NUM_VECTORS];
+        FloatVector *fv = set->floats[i], *fw = set->floats[(i + 1) % NUM_VECTORS];
+        QuantizedVector *qv = set->quantized[i], *qw = set->quantized[(i + 1) % NUM_VECTORS];
+        double norm = 0, otherNorm = 0, dot = 0, floatDot = 0, quantizedDot = 0;
+        for (int j = 0; j < dim; j++)
+        {
+            norm += v->vector[j] * v->vector[j];
+            otherNorm += w->vector[j] * w->vector[j];
+            dot += v->vector[j] * w->vector[j];
+            floatDot += (double) fv->vector[j] * fw->vector[j];
+            quantizedDot += (qv->vector[j] * qv->scale) * (qw->vector[j] * qw->scale);
+        }
+        // dot products are relative to the norms, a dot product near 0 has no relative error.
+        double scale = sqrt(norm * otherNorm);
+        normError[0] = fmax(normError[0], fabs(calcFloatVectorSquaredNorm(fv) - norm) / norm);
+        normError[1] = fmax(normError[1], fabs(calcQuantizedVectorSquaredNorm(qv) - norm) / norm);
+        dotError[0] = fmax(dotError[0], fabs(floatDot - dot) / scale);
+        dotError[1] = fmax(dotError[1], fabs(quantizedDot - dot) / scale);
+    }
+    printf("%5d  norm error  float %.2e  int8 %.2e   dot error  float %.2e  int8 %.2e\n", dim,
+           normError[0], normError[1], dotError[0], dotError[1]);
+}
+
+/**
+ * times the squared norms of all the vectors of a representation, with the caches cleared, and
+ * comparisons of every vector with itself, which read it to the end.
+ * @param type - 0 for doubles, 1 for floats, 2 for int8.
+ * @param compare - 0 to time the norms, other to time the comparisons.
+ * @return the fastest time of a run, in seconds.
+ */
+double timeReduced(const ReducedSet *set, int type, int compare)
+{
+    double best = 0;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        double sum = 0;
+        double start = benchNow();
+        for (int i = 0; i < NUM_VECTORS; i++)
+        {
+            if (type == 0)
+            {
+                invalidateVectorCache(set->dense[i]);
+                sum += compare ? vectorCompare1By1(set->dense[i], set->dense[i])
+                               : getCachedVectorSquaredNorm(set->dense[i]);
+            }
+            else if (type == 1)
+            {
+                set->floats[i]->flags &= ~VECTOR_NORM_CACHED;
+                sum += compare ? floatVectorCompare1By1(set->floats[i], set->floats[i])
+                               : calcFloatVectorSquaredNorm(set->floats[i]);
+            }
+            else
+            {
+                set->quantized[i]->flags &= ~VECTOR_NORM_CACHED;
+                sum += compare ? quantizedVectorCompare1By1(set->quantized[i], set->quantized[i])
+                               : calcQuantizedVectorSquaredNorm(set->quantized[i]);
+            }
+        }
+        double elapsed = benchNow() - start;
+        benchSink = sum;
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/**
+ * prints the error of float and int8 vectors against the doubles they were made of, and the
+ * throughput of the norms and the comparisons of the three, in millions of vectors per second,
+ * for several dimensions.
+ */
+int main()
+{
+    const int dims[] = {16, 128, 1024};
+    const int numDims = sizeof(dims) / sizeof(dims[0]);
+    ReducedSet sets[sizeof(dims) / sizeof(dims[0])];
+    srand(40);
+    for (int d = 0; d < numDims; d++)
+    {
+        if (!newReducedSet(&sets[d], dims[d]))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+
+    printf("%d vectors, largest relative error against doubles\n%5s\n", NUM_VECTORS, "dim");
+    for (int d = 0; d < numDims; d++)
+    {
+        printReducedErrors(&sets[d], dims[d]);
+    }
+    printf("\nMvectors/s\n%-8s %5s %10s %10s %10s\n", "kernel", "dim", "double", "float", "int8");
+    for (int compare = 0; compare <= 1; compare++)
+    {
+        for (int d = 0; d < numDims; d++)
+        {
+            printf("%-8s %5d", compare ? "compare" : "norm", dims[d]);
+            for (int type = 0; type < 3; type++)
+            {
+                printf(" %10.2f", NUM_VECTORS / timeReduced(&sets[d], type, compare) * 1e-6);
+            }
+            printf("\n");
+        }
+    }
+    for (int d = 0; d < numDims; d++)
+    {
+        freeReducedSet(&sets[d]);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "VectorScores.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#define NUM_VECTORS 50000
+#define NUM_RUNS 3 // the fastest run is reported.
+
+// keeps the results alive, so the calls aren't optimized away.
+volatile double benchSink;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * allocates n vectors of the given dimension with random coefficients in [-1, 1).
+ * @return the array of pointers, NULL on failure.
+ */
+Vector **newRandomVectors(int n, int dim)
+{
+    Vector **vectors = (Vector **) malloc(n * sizeof(Vector *));
+    double *coefficients = (double *) malloc((size_t) n * dim * sizeof(double));
+    Vector *structs = (Vector *) malloc(n * sizeof(Vector));
+    if (vectors == NULL || coefficients == NULL || structs == NULL)
+    {
+        free(vectors);
+        free(coefficients);
+        free(structs);
+        return NULL;
+    }
+    for (size_t i = 0; i < (size_t) n * dim; i++)
+    {
+        coefficients[i] = 2.0 * rand() / ((double) RAND_MAX + 1) - 1;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        initVector(&structs[i], &coefficients[(size_t) i * dim], dim);
+        vectors[i] = &structs[i];
+    }
+    return vectors;
+}
+
+/**
+ * frees vectors allocated by newRandomVectors.
+ */
+void freeRandomVectors(Vector **vectors)
+{
+    free(vectors[0]->vector);
+    free(vectors[0]);
+    free(vectors);
+}
+
+/**
+ * the baseline: scores the vectors one at a time with plain loops, recomputing every norm.
+ */
+void scoreVectorsNaive(Vector *const *vectors, int n, const Vector *q, ScoreType type,
+                       double *scores)
+{
+    for (int i = 0; i < n; i++)
+    {
+        double dot = 0, vNorm = 0, qNorm = 0;
+        for (int j = 0; j < q->len; j++)
+        {
+            dot += vectors[i]->vector[j] * q->vector[j];
+            vNorm += vectors[i]->vector[j] * vectors[i]->vector[j];
+            qNorm += q->vector[j] * q->vector[j];
+        }
+        scores[i] = (type == DOT_SCORE) ? dot : dot / sqrt(vNorm * qNorm);
+    }
+}
+
+/**
+ * times scoring the vectors against the query.
+ * @param nThreads - threads of scoreVectors, 0 for scoreVectorsNaive.
+ * @return the fastest time of a run, in seconds.
+ */
+double timeScores(Vector *const *vectors, const Vector *q, ScoreType type, double *scores,
+                  int nThreads)
+{
+    double best = 0;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        double start = benchNow();
+        if (nThreads == 0)
+        {
+            scoreVectorsNaive(vectors, NUM_VECTORS, q, type, scores);
+        }
+        else if (!scoreVectors(vectors, NUM_VECTORS, q, type, scores, nThreads))
+        {
+            return -1;
+        }
+        double elapsed = benchNow() - start;
+        benchSink = scores[NUM_VECTORS - 1];
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/**
+ * prints the throughput of scoreVectors with 1, 2 and 4 threads against a naive loop, in
+ * millions of vectors per second and GB of coefficients per second, for dot and cosine scores in
+ * several dimensions. the scores of every run are checked against the naive ones.
+ */
+int main()
+{
+    const int dims[] = {8, 64, 256, 1024};
+    const char *types[] = {"dot", "cosine"};
+    const int threads[] = {0, 1, 2, 4}; // 0 stands for the naive loop.
+    const int numThreads = sizeof(threads) / sizeof(threads[0]);
+    double *expected = (double *) malloc(NUM_VECTORS * sizeof(double));
+    double *scores = (double *) malloc(NUM_VECTORS * sizeof(double));
+    if (expected == NULL || scores == NULL)
+    {
+        free(expected);
+        free(scores);
+        return EXIT_FAILURE;
+    }
+    int mismatches = 0;
+    srand(43);
+
+    printf("%d vectors, Mvectors/s (GB/s)\n%-6s %5s %16s", NUM_VECTORS, "score", "dim", "naive");
+    for (int t = 1; t < numThreads; t++)
+    {
+        printf("      %2d thread%s", threads[t], (threads[t] == 1) ? " " : "s");
+    }
+    printf("\n");
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++)
+    {
+        Vector **vectors = newRandomVectors(NUM_VECTORS, dims[d]);
+        Vector **q = newRandomVectors(1, dims[d]);
+        if (vectors == NULL || q == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        double bytes = (double) NUM_VECTORS * dims[d] * sizeof(double);
+        for (int type = DOT_SCORE; type <= COSINE_SCORE; type++)
+        {
+            printf("%-6s %5d", types[type], dims[d]);
+            for (int t = 0; t < numThreads; t++)
+            {
+                int nThreads = threads[t];
+                double elapsed = timeScores(vectors, q[0], (ScoreType) type,
+                                            (nThreads == 0) ? expected : scores, nThreads);
+                if (elapsed < 0)
+                {
+                    return EXIT_FAILURE;
+                }
+                printf(" %8.1f (%5.1f)", NUM_VECTORS / elapsed * 1e-6, bytes / elapsed * 1e-9);
+                for (int i = 0; nThreads > 0 && i < NUM_VECTORS; i++)
+                {
+                    mismatches += fabs(scores[i] - expected[i]) > 1e-9 * (1 + fabs(expected[i]));
+                }
+            }
+            printf("\n");
+        }
+        freeRandomVectors(vectors);
+        freeRandomVectors(q);
+    }
+    free(expected);
+    free(scores);
+    printf("%d mismatches against the naive scores\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,205 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "VectorStore.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_RUNS 3 // the fastest run is reported.
+#define NUM_CONFIGS 2
+
+/**
+ * the times of a single run, in seconds.
+ */
+typedef struct StoreTimes
+{
+    double heapTreeScan; // forEachRBTree over vectors of two mallocs each.
+    double storeTreeScan; // forEachRBTree over vectors of a store.
+    double storeScan; // forEachVectorStore.
+    double heapAlloc; // allocating and copying the vectors, two mallocs each.
+    double storeAlloc; // adding the vectors to a store.
+    double heapFree; // freeRBTree with freeVector.
+    double storeFree; // freeRBTree with freeStoreVector, and freeVectorStore.
+} StoreTimes;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * ForEach function that adds the squared norm of a vector to a sum, computing it every time.
+ * @param pVector - Vector*
+ * @param pSum - double* with the sum.
+ * @return 1
+ */
+int addSquaredNorm(const void *pVector, void *pSum)
+{
+    *(double *) pSum += calcVectorSquaredNorm((const Vector *) pVector);
+    return 1;
+}
+
+/**
+ * allocates a vector as the rest of the code does: the Vector and its coefficients are two
+ * allocations.
+ * @param coefficients - array of len doubles to copy.
+ * @return the new vector, NULL on failure.
+ */
+Vector *newHeapVector(const double *coefficients, int len)
+{
+    Vector *v = (Vector *) malloc(sizeof(Vector));
+    double *copy = (double *) malloc(len * sizeof(double));
+    if (v == NULL || copy == NULL)
+    {
+        free(v);
+        free(copy);
+        return NULL;
+    }
+    memcpy(copy, coefficients, len * sizeof(double));
+    initVector(v, copy, len);
+    return v;
+}
+
+/**
+ * keeps the fastest of two times of every step.
+ * @param best - the fastest times so far, will hold the fastest times.
+ * @param times - the times of a run.
+ */
+void keepFastest(StoreTimes *best, const StoreTimes *times)
+{
+    best->heapTreeScan = fmin(best->heapTreeScan, times->heapTreeScan);
+    best->storeTreeScan = fmin(best->storeTreeScan, times->storeTreeScan);
+    best->storeScan = fmin(best->storeScan, times->storeScan);
+    best->heapAlloc = fmin(best->heapAlloc, times->heapAlloc);
+    best->storeAlloc = fmin(best->storeAlloc, times->storeAlloc);
+    best->heapFree = fmin(best->heapFree, times->heapFree);
+    best->storeFree = fmin(best->storeFree, times->storeFree);
+}
+
+/**
+ * runs the benchmark once: allocates n vectors on the heap and in a store, adds each of them to a
+ * tree, sums their norms by scanning the trees and the store, and frees them.
+ * @param coefficients - n * dim random doubles.
+ * @param times - will hold the times of the run.
+ * @param sums - will hold the sums of the heap tree, the store tree and the store scans.
+ * @return 0 on failure, other on success.
+ */
+int runStore(const double *coefficients, int n, int dim, StoreTimes *times, double *sums)
+{
+    Vector **heapVectors = (Vector **) malloc(n * sizeof(Vector *));
+    Vector **storeVectors = (Vector **) malloc(n * sizeof(Vector *));
+    VectorStore *store = newVectorStore(0);
+    RBTree *heapTree = newRBTree(vectorCompare1By1, freeVector);
+    RBTree *storeTree = newRBTree(vectorCompare1By1, freeStoreVector);
+    int valid = (heapVectors != NULL && storeVectors != NULL && store != NULL && heapTree != NULL &&
+                 storeTree != NULL);
+
+    double start = benchNow();
+    for (int i = 0; valid && i < n; i++)
+    {
+        heapVectors[i] = newHeapVector(coefficients + (size_t) i * dim, dim);
+        valid = (heapVectors[i] != NULL);
+    }
+    double middle = benchNow();
+    for (int i = 0; valid && i < n; i++)
+    {
+        storeVectors[i] = addToVectorStore(store, coefficients + (size_t) i * dim, dim);
+        valid = (storeVectors[i] != NULL);
+    }
+    double end = benchNow();
+    times->heapAlloc = middle - start;
+    times->storeAlloc = end - middle;
+    for (int i = 0; valid && i < n; i++)
+    {
+        valid = addToRBTree(heapTree, heapVectors[i]) && addToRBTree(storeTree, storeVectors[i]);
+    }
+
+    if (valid)
+    {
+        sums[0] = sums[1] = sums[2] = 0;
+        start = benchNow();
+        forEachRBTree(heapTree, addSquaredNorm, &sums[0]);
+        times->heapTreeScan = benchNow() - start;
+        start = benchNow();
+        forEachRBTree(storeTree, addSquaredNorm, &sums[1]);
+        times->storeTreeScan = benchNow() - start;
+        start = benchNow();
+        forEachVectorStore(store, addSquaredNorm, &sums[2]);
+        times->storeScan = benchNow() - start;
+    }
+
+    start = benchNow();
+    freeRBTree(heapTree); // frees the vectors in it too.
+    middle = benchNow();
+    freeRBTree(storeTree);
+    freeVectorStore(store);
+    end = benchNow();
+    times->heapFree = middle - start;
+    times->storeFree = end - middle;
+    free(heapVectors);
+    free(storeVectors);
+    return valid;
+}
+
+/**
+ * prints the time to sum the norms of all the vectors of a tree whose vectors are two mallocs
+ * each, of a tree of vectors of a VectorStore, and of the store itself in the order the vectors
+ * were added. the times to allocate and free the vectors are printed as well.
+ * @return 0 if all the scans summed the same norms, 1 otherwise.
+ */
+int main()
+{
+    const int counts[NUM_CONFIGS] = {1000000, 200000};
+    const int dims[NUM_CONFIGS] = {16, 128};
+    int mismatches = 0;
+    srand(38);
+
+    printf("times in ms\n%-14s %10s %11s %11s %11s %12s %10s %11s\n", "vectors", "heap tree",
+           "store tree", "store scan", "heap alloc", "store alloc", "heap free", "store free");
+    for (int config = 0; config < NUM_CONFIGS; config++)
+    {
+        int n = counts[config];
+        int dim = dims[config];
+        double *coefficients = (double *) malloc((size_t) n * dim * sizeof(double));
+        if (coefficients == NULL)
+        {
+            return EXIT_FAILURE;
+        }
+        for (size_t i = 0; i < (size_t) n * dim; i++)
+        {
+            coefficients[i] = (double) rand() / RAND_MAX - 0.5;
+        }
+        StoreTimes best = {0, 0, 0, 0, 0, 0, 0};
+        for (int run = 0; run < NUM_RUNS; run++)
+        {
+            StoreTimes times;
+            double sums[3];
+            if (!runStore(coefficients, n, dim, &times, sums))
+            {
+                free(coefficients);
+                return EXIT_FAILURE;
+            }
+            mismatches += (sums[0] != sums[1] || fabs(sums[0] - sums[2]) > 1e-9 * sums[0]);
+            if (run == 0)
+            {
+                best = times;
+            }
+            keepFastest(&best, &times);
+        }
+        free(coefficients);
+        char name[32];
+        snprintf(name, sizeof(name), "%dk x %d", n / 1000, dim);
+        printf("%-14s %10.1f %11.1f %11.1f %11.1f %12.1f %10.1f %11.1f\n", name,
+               best.heapTreeScan * 1e3, best.storeTreeScan * 1e3, best.storeScan * 1e3,
+               best.heapAlloc * 1e3, best.storeAlloc * 1e3, best.heapFree * 1e3,
+               best.storeFree * 1e3);
+    }
+    printf("%d scans summed different norms\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include "RBTree.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_KEYS 1000000
+#define NUM_LOOKUPS 2000000
+#define NUM_RUNS 3 // the fastest run is reported.
+#define MAX_KEY_LEN 64
+#define NUM_HOSTS 1000 // hosts of the URLs of many hosts.
+
+/**
+ * the datasets of the benchmark.
+ */
+typedef enum Dataset
+{
+    IDENTIFIERS, // random letters and digits, 6 to 15 chars.
+    MANY_HOSTS, // "https://h<host>.example.com/item/<n>", the hosts differ within 16 bytes.
+    ONE_HOST // "https://www.example.com/item/<n>", all the keys share 29 bytes.
+} Dataset;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * CompareFunc for strings.
+ */
+int benchStringCompare(const void *a, const void *b)
+{
+    return strcmp((const char *) a, (const char *) b);
+}
+
+/**
+ * writes a random key of the given dataset.
+ * @param key - buffer of MAX_KEY_LEN chars.
+ */
+void makeKey(Dataset dataset, char *key)
+{
+    static const char chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_";
+    if (dataset == IDENTIFIERS)
+    {
+        int len = 6 + rand() % 10;
+        for (int i = 0; i < len; i++)
+        {
+            key[i] = chars[rand() % (int) (sizeof(chars) - 1)];
+        }
+        key[len] = '\0';
+    }
+    else if (dataset == MANY_HOSTS)
+    {
+        snprintf(key, MAX_KEY_LEN, "https://h%d.example.com/item/%d", rand() % NUM_HOSTS, rand());
+    }
+    else
+    {
+        snprintf(key, MAX_KEY_LEN, "https://www.example.com/item/%d", rand());
+    }
+}
+
+/**
+ * times adding all the keys to a tree, and looking up the probes in it.
+ * @param stringTree - 0 for a tree ordered by a CompareFunc that calls strcmp, other for
+ * newStringRBTree.
+ * @param keys - NUM_KEYS strings, some of them may repeat.
+ * @param probes - NUM_LOOKUPS strings, about half of them in the tree.
+ * @param insertTime - will hold the fastest insertion time, in seconds.
+ * @param lookupTime - will hold the fastest lookup time, in seconds.
+ * @param found - will hold the number of probes found and the size of the tree.
+ * @return 0 on failure, other on success.
+ */
+int timeTree(int stringTree, char *const *keys, char *const *probes, double *insertTime,
+             double *lookupTime, long *found)
+{
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        RBTree *tree = stringTree ? newStringRBTree(NULL) : newRBTree(benchStringCompare, NULL);
+        if (tree == NULL)
+        {
+            return 0;
+        }
+        double start = benchNow();
+        for (int i = 0; i < NUM_KEYS; i++)
+        {
+            addToRBTree(tree, keys[i]);
+        }
+        double middle = benchNow();
+        long count = tree->size;
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            count += containsRBTree(tree, probes[i]);
+        }
+        double end = benchNow();
+        freeRBTree(tree);
+        if (run == 0 || middle - start < *insertTime)
+        {
+            *insertTime = middle - start;
+        }
+        if (run == 0 || end - middle < *lookupTime)
+        {
+            *lookupTime = end - middle;
+        }
+        *found = count;
+    }
+    return 1;
+}
+
+/**
+ * prints the insertion and lookup times of string trees ordered by strcmp through a CompareFunc,
+ * and of newStringRBTree trees that compare the 16 byte prefixes cached in their nodes first, on
+ * identifiers, on URLs of many hosts and on URLs of a single host. the URLs of a host share more
+ * than the cached prefix, so the comparisons near the leaves read the strings in both trees.
+ * @return 0 if both trees found the same strings, 1 otherwise.
+ */
+int main()
+{
+    const char *datasets[] = {"identifiers", "many hosts", "one host"};
+    char *buffer = (char *) malloc((size_t) 2 * NUM_KEYS * MAX_KEY_LEN);
+    char **keys = (char **) malloc(NUM_KEYS * sizeof(char *));
+    char **probes = (char **) malloc(NUM_LOOKUPS * sizeof(char *));
+    if (buffer == NULL || keys == NULL || probes == NULL)
+    {
+        free(buffer);
+        free(keys);
+        free(probes);
+        return EXIT_FAILURE;
+    }
+    srand(32);
+
+    int mismatches = 0;
+    printf("%d keys, %d lookups\n%-12s %-8s %10s %12s\n", NUM_KEYS, NUM_LOOKUPS, "dataset", "tree",
+           "insert ms", "lookups ms");
+    for (int dataset = IDENTIFIERS; dataset <= ONE_HOST; dataset++)
+    {
+        for (int i = 0; i < 2 * NUM_KEYS; i++) // the second half are probes that may be missing.
+        {
+            makeKey((Dataset) dataset, buffer + (size_t) i * MAX_KEY_LEN);
+        }
+        for (int i = 0; i < NUM_KEYS; i++)
+        {
+            keys[i] = buffer + (size_t) i * MAX_KEY_LEN;
+        }
+        for (int i = 0; i < NUM_LOOKUPS; i++)
+        {
+            probes[i] = buffer + (size_t) (rand() % (2 * NUM_KEYS)) * MAX_KEY_LEN;
+        }
+        long expected = 0;
+        for (int stringTree = 0; stringTree <= 1; stringTree++)
+        {
+            double insertTime = 0, lookupTime = 0;
+            long found = 0;
+            if (!timeTree(stringTree, keys, probes, &insertTime, &lookupTime, &found))
+            {
+                free(buffer);
+                free(keys);
+                free(probes);
+                return EXIT_FAILURE;
+            }
+            mismatches += (stringTree && found != expected);
+            expected = found;
+            printf("%-12s %-8s %10.1f %12.1f\n", datasets[dataset],
+                   stringTree ? "prefix" : "strcmp", insertTime * 1e3, lookupTime * 1e3);
+        }
+    }
+    free(buffer);
+    free(keys);
+    free(probes);
+    printf("%d mismatches against the strcmp tree\n", mismatches);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
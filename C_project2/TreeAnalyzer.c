@@ -1,24 +1,25 @@
+#define _POSIX_C_SOURCE 200809L // for mmap with -std=c99
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "string.h"
-#include "queue.h"
 
 // Constants //
-#define TXT_FILE_LINE_LEN_LIMIT 1025 //(1024 + null val)
 #define ARGC_ERROR_MSG "Usage: TreeAnalyzer <Graph File Path> <First Vertex> <Second Vertex>\n"
 #define INVALID_INPUT_MSG "Invalid input\n"
 #define EXPECTED_ARGS_NUM 3
-#define TXT_FILE_MIN_LINES 2 // for n nodes specification and the first node (cause n=0 is illegal).
-#define NODE_KEY(LINE_NUM) (LINE_NUM - 2)
-#define LIN_LEAF_SYMBOL_EOL "-\n"
-#define WIN_LEAF_SYMBOL_EOL "-\r\n"
-#define NODE_CHILDREN_TXT_DELIMITER " \r\n"
+#define MIN_NODE_LINE_LEN 2 // the shortest node line is a leaf - "-\n".
+#define IS_CHILDREN_DELIMITER(C) ((C) == ' ' || (C) == '\r')
 #define VALID_N_EDGES_IN_TREE(N) (N - 1)
 #define MEMORY_ERROR_MSG "Memory problem occurred, exiting..."
-#define FIRST_NODE_ROW_IN_FILE 2
 #define UNINITIALIZED_TREE_VAL -1
 #define LEAF_SYMBOL '-'
-#define VALID_LINE_NUM_IN_FILE(N) (N + 1)
+#define DECIMAL_BASE 10
 
 // Declarations //
 
@@ -27,27 +28,40 @@
  */
 typedef struct Node
 {
-    int *children;
     int parentNodeKey;
     int key;
     int isLeaf;
-    int nChildren;
-    //BFS utils
-    int previousKey;
-    int dist;
+    //path queries utils, set by calcTreeMetrics
+    int depth; // length of the route from the root.
+    int jumpKey; // key of an ancestor to skip to, up to half the depth above the node.
 } Node;
 
 /**
  * represent a Tree data structure.
+ * the children are kept in a compressed sparse row layout: the children of node v are
+ * children[childOffsets[v]] ... children[childOffsets[v + 1] - 1], so all of them lie in a single
+ * array, ordered by their parents keys.
  */
 typedef struct Tree
 {
     Node *root;
     Node *nodes; // array of Nodes in the heap.
+    int *childOffsets; // nVertices + 1 offsets to children, in the heap.
+    int *children; // keys of the children of all nodes, in the heap.
     int nVertices;
     int nEdges;
 } Tree;
 
+/**
+ * the metrics of a tree, computed together by calcTreeMetrics.
+ */
+typedef struct TreeMetrics
+{
+    int minHeight; // length of the shortest route from the root to a leaf.
+    int maxHeight; // length of the longest route from the root to a leaf.
+    int diameter; // length of the longest simple route in the tree.
+} TreeMetrics;
+
 /**
  * enum to determine which error occurred during run.
  */
@@ -58,6 +72,16 @@ typedef enum Error
     MEM_ERR
 } ErrStatus;
 
+/**
+ * a txt file mapped to memory (read only), parsed line by line in a single forward pass.
+ */
+typedef struct TextFile
+{
+    char *data;
+    size_t size;
+    const char *next; // start of the next line to parse.
+} TextFile;
+
 /**
  * manages pre processing the tree data and analyze the tree created.
  * @param argv  - arguments from user
@@ -84,45 +108,58 @@ ErrStatus buildTree(const char *filePath, char *firstNode, char *secondNode, Tre
 
 /**
  * sets multiple variables used building the tree:
- * this function loads the file into the given pointer, parse and read the first row in file
+ * this function maps the file to memory, parse and read the first row in file
  * specifying the number of nodes into a variable, and checks the two supplied nodes key.
 
  * @param filePath - valid path for the graph txt file.
- * @param fp FILE pointer, will be used to parse the whole file outside this scope.
+ * @param file - will hold the mapped file, positioned at the first node line, and will be used
+ * to parse the whole file outside this scope.
  * @param firstNode - first node string argument given.
  * @param secondNode - second node string argument given.
  * @param inputNumVertices - number of vertices to be in the tree specified in the txt file.
  * @param uKey - parsed first node value, will be updated if function will succeed.
  * @param vKey - parsed second node value.
  * @return the given pointer will be updated and SUCCESS will return if no problems found or
- * occurred with one of the arguments. otherwise FAILURE. MEM_ERR if malloc have failed.
+ * occurred with one of the arguments. otherwise FAILURE.
  */
-ErrStatus initTools(const char *filePath, FILE **fp, char *firstNode, char *secondNode,
+ErrStatus initTools(const char *filePath, TextFile *file, char *firstNode, char *secondNode,
                     int *inputNumVertices, int *uKey, int *vKey);
 
 /**
- * Helper function to load txt file given by the user. this function will update a FILE pointer
- * with the pointer to the file, and will register in another pointer the size of the file
- * (numOfLines).
- * the function also checks if the number of lines is below the minimal required for valid input.
+ * Helper function to load txt file given by the user. this function maps the whole file to
+ * memory instead of reading it, so every line is parsed in place, once, with no copies.
  * @param filePath - path provided by user.
- * @param fp - FILE pointer, will be updated with the opened file.
- * @param fSize - int pointer, will be updated with the correct length of file.
- * @return ErrStatus SUCCESS or FAILURE if there was a problem reading the file or with
- * it's length. MEM_ERR if a malloc call have failed.
+ * @param file - will be updated with the mapped file, positioned at its first line.
+ * @return ErrStatus SUCCESS or FAILURE if there was a problem opening or mapping the file (or if
+ * it's empty).
  */
-ErrStatus loadFile(const char *filePath, FILE **fp, int *fSize);
+ErrStatus loadFile(const char *filePath, TextFile *file);
+
+/**
+ * unmaps a file mapped by loadFile (does nothing if it isn't mapped).
+ * @param file - the file.
+ */
+void unloadFile(TextFile *file);
+
+/**
+ * reads the next line of a mapped file, and moves the file to the line after it.
+ * @param file - the mapped file.
+ * @param line - will point to the first char of the line.
+ * @param lineEnd - will point right after the last char of the line (the '\n' is not part of
+ * the line).
+ * @return 0 if there are no more lines in the file, other otherwise.
+ */
+int nextLine(TextFile *file, const char **line, const char **lineEnd);
 
 /**
  * checks and parses the  number of vertices in the tree, given in the first row of the txt file.
- * n should be a int number s.t n != 0, this function check if n == numOfRows in file, but this
- * doesn't cover the case when the number of line is ok but those lines are empty.
- * @param fp - FILE pointer to the txt file.
- * @param fileLength numOfLines in file
+ * n should be a int number s.t n != 0. the number of lines is checked while adding the vertices,
+ * here n is only checked to fit in the file size, so no memory is allocated for an impossible n.
+ * @param file - the mapped txt file, positioned at the first row.
  * @param numVertices - pointer to the output value.
  * @return ErrStatus SUCCESS or FAIL.
  */
-ErrStatus setVerticesNumber(FILE *fp, int fileLength, int *numVertices);
+ErrStatus setVerticesNumber(TextFile *file, int *numVertices);
 
 /**
  * Helper function to parse strings to integers.
@@ -132,6 +169,16 @@ ErrStatus setVerticesNumber(FILE *fp, int fileLength, int *numVertices);
  */
 ErrStatus parseNum(char *num, int *out);
 
+/**
+ * Helper function to parse a number in a line of the txt file, as parseNum parses a string that
+ * ends right after the number (the number isn't null terminated).
+ * @param num - first char of the number.
+ * @param numEnd - right after the last char of the number.
+ * @param out - int pointer, will be updated with the parsed value.
+ * @return ErrStatus SUCCESS or FAILURE (also if the number doesn't fit in an int).
+ */
+ErrStatus parseKey(const char *num, const char *numEnd, int *out);
+
 /**
  * basic test for input nodes validity as a fail-fast mechanism.
  * tries to parse the nodes keys to numbers, and check if they within range of valid nodes [0,|V|]
@@ -151,32 +198,38 @@ ErrStatus checkInputNodes(char first[], char second[], int *firstNodeKey, int *s
  * file, while checking for problems with input.
  * the function will update existing nodes array in the tree, and fill their data.
  *
- * Memory Note: for every node, an array of ints is allocated to register his children, if
- * something will went wrong with the problem, the method freeTree will handle all memory
- * allocated, including this one.
+ * the nodes lines are in the order of their keys, so the children of every node are appended to
+ * tree->children right after the children of the previous node, and the offsets are filled in
+ * the same pass.
  *
- * @param fp - FILE pointer to the txt file.
+ * @param file - the mapped txt file, positioned at the first node line.
  * @param inputNumVertices - number of vertices supplied in the first row in the file.
- * @param tree - the tree to build, tree->nodes assumed to be initialized before call.
- * @return EXIT_SUCCESS, otherwise EXIT_FAILURE.
+ * @param tree - the tree to build, tree->nodes, tree->childOffsets (inputNumVertices + 1 ints)
+ * and tree->children (at least VALID_N_EDGES_IN_TREE(inputNumVertices) ints) assumed to be
+ * initialized before call.
+ * @return SUCCESS or FAIL (also if the file has an empty line or more than inputNumVertices node
+ * lines, or if there are more children than edges in a valid tree).
  */
-ErrStatus addTreeVertices(FILE *fp, int inputNumVertices, Tree *tree);
+ErrStatus addTreeVertices(TextFile *file, int inputNumVertices, Tree *tree);
 
 /**
 * links vertex sons specified in the line in a list of numbers separated with spaces.
 * valid input is string of numbers of type int s.t 0 =< x =< |V| else iff whole line is "-"
 * means V is a leaf.
 * the function receives all nodes in tree array, and update for each children it's parent (based
-* on assumption that the key is the location in the tree array).
+* on assumption that the key is the location in the tree array). the children are appended to
+* tree->children after the tree->nEdges children added so far.
 * input assumptions: every value in the numbers list is separated by one space;
-* @param line - line in txt file, containing data about children of node.
+* @param line - line in txt file, containing data about children of node (not empty).
+* @param lineEnd - right after the last char of the line.
 * @param parent - pointer to the parent node.
 * @param tree - pointer to the tree.
 * @param childCounter will be updated with number of children parsed for the parent.
 * @param numVertices - number of given vertices by input.
-* @return - SUCCESS, FAIL or MEM_ERR if a malloc call have failed.
+* @return - SUCCESS or FAIL.
  */
-ErrStatus parseChildren(char *line, Node *parent, Tree *tree, int *childCounter, int numVertices);
+ErrStatus parseChildren(const char *line, const char *lineEnd, Node *parent, Tree *tree,
+                        int *childCounter, int numVertices);
 
 /**
  * this function iterates over the built nodes and choose the node with no parent to be the tree
@@ -197,62 +250,76 @@ ErrStatus setRoot(Tree *tree);
  * @param tree - tree to investigate.
  * @param pathStartNodeKey - key of a node in the tree.
  * @param pathEndNodeKey  - key of a node in the tree.
+ * @return SUCCESS (after printing), FAIL if the tree has a circle or MEM_ERR (before printing).
  */
-void printTreeDetails(const Tree *tree, int pathStartNodeKey, int pathEndNodeKey);
+ErrStatus printTreeDetails(const Tree *tree, int pathStartNodeKey, int pathEndNodeKey);
 
 /**
- * free heap memory allocated for the tree - array of children for each node,
+ * free heap memory allocated for the tree - the children and their offsets,
  * and the array of nodes in the tree. and the nodes themselves.
  * @param tree - pointer to the tree.
  */
 void freeTree(Tree *tree);
 
 /**
- * BFS implementation for the tree.
- * assumptions - 1. the tree nodes can be accessed in the tree's nodes array by their key.
- *               2. the dist and prev fields updated during run are ints and not pointers, so
- *               infinity is represented by the invalid value -1.
- * Running time - O(|V|+|E|) = O(2n-1) = O(n).
- * @param tree pointer to the graph (tree in our case).
- * @param start - starting node (of type Node).
+ * finds the ancestor of a node in a given depth, using the jump pointers of calcTreeMetrics.
+ * Running time - O(log n).
+ * @param tree pointer to a tree with a path index.
+ * @param nodeKey key of a node in the tree.
+ * @param depth depth of the ancestor, at most the depth of the node.
+ * @return the key of the ancestor.
  */
-void BFS(const Tree *tree, int startNodeKey);
+int findAncestorAtDepth(const Tree *tree, int nodeKey, int depth);
 
 /**
- * Finds the minimal and maximal heights exists in the tree, e.g the longest and shortest routes
- * from the tree root to a leaf.
- * the function calls BFS to set the shortest routes from the root of the tree, and than iterate
- * over leaves and update the longest and shortest routs.
- * @param tree pointer to a Tree
- * @param maxHeight pointer to int result val
- * @param minHeight pointer to int result val
- * @param deepestLeafKey int Key of to the most far leaf from root in the tree.
+ * finds the lowest common ancestor of two nodes, the highest node in the route between them,
+ * using the jump pointers of calcTreeMetrics.
+ * the two nodes are brought to the same depth, and then go up together. their jump pointers lead
+ * to the same depth, so while they lead to different nodes both nodes can jump, otherwise both
+ * step to their parents.
+ * Running time - O(log n).
+ * @param tree pointer to a tree with a path index.
+ * @param uKey key of a node in the tree.
+ * @param vKey key of a node in the tree.
+ * @return the key of the lowest common ancestor.
  */
-void calcMinimalAndMaximalHeight(const Tree *tree, int *maxHeight, int *minHeight, int
-                                 *deepestLeafKey);
+int findLowestCommonAncestor(const Tree *tree, int uKey, int vKey);
 
 /**
- * find the delimiter of the tree, e.g the longest simple route in the tree.
- * we can assume that the diameter route will start and end in a leaf, otherwise we could go deeper
- * and achieve more distance. Thus, using the most far leaf from the root, we can find the
- * diameter finding the longest route from it to another leaf.
- * running time - max num of leaves is
- * @param tree - pointer to a tree.
- * @param deepestLeaf - address to a leaf in the tree that is in the end of the longest route
- * from root.
- * @param diameter - the int result value.
+ * Finds the minimal and maximal heights exists in the tree, e.g the longest and shortest routes
+ * from the root to a leaf, and the diameter of the tree, in two passes over the nodes instead of
+ * a BFS for each:
+ * 1. the nodes are put in BFS order from the root (every parent before its children), and the
+ *    depth of every node is set from its parent, so the heights are the min and max leaf depths.
+ *    every node also gets a jump pointer to one of its ancestors, for path queries. the jumps
+ *    follow the skew binary numbers: a node jumps as far as its parent jump pointer's jump
+ *    pointer when the two jumps of its parent have the same length, otherwise to its parent. so
+ *    from every node, any ancestor can be reached in O(log n) jumps and steps to parents. binary
+ *    lifting would answer as fast, but keeps log n ancestors per node (27 ints per node in a tree
+ *    of 10^8 nodes), here it's a single int per node.
+ * 2. the nodes are visited in reverse order (every child before its parent), and the height of
+ *    every subtree is set from the two highest subtrees of its children. the longest route whose
+ *    highest node is v goes down through those two, so the diameter is the longest of them.
+ * Running time - O(n), with no queue and no resets of the nodes BFS fields.
+ * @param tree pointer to a Tree
+ * @param metrics will be updated with the results.
+ * @return SUCCESS, FAIL if some nodes can't be reached from the root (they form a circle), or
+ * MEM_ERR.
  */
-void calcTreeDiameter(const Tree *tree, int deepestLeafKey, int *diameter);
+ErrStatus calcTreeMetrics(const Tree *tree, TreeMetrics *metrics);
 
 /**
  * finds shortest route between two given nodes and output the nodes key in the route.
- * the path is u->v, but the function will start from the end and reverse order to result in
- * correct output.
+ * the route goes up from u to the lowest common ancestor of u and v, and down from it to v, so
+ * after calcTreeMetrics every route takes O(log n + route length), rather than a BFS of the tree.
+ * the part from v is written from the end of the route backwards, to result in correct output.
  * will result in an array allocated in the heap! need to free after use.
- * @param tree a pointer to the tree
+ * @param tree a pointer to the tree, with a path index.
  * @param startNodeKey  key of a valid node in the tree to start path from
  * @param endNode - key of a valid node in the tree to end the path.
  * @param nodesInRoute - pointer to an array of the nodes keys in path - the result.
+ * @param pathLen - will be updated with the number of nodes in path, 0 if the array couldn't be
+ * allocated.
  */
 void findDistance(const Tree *tree, int startNodeKey, int endNodeKey,
                   int **nodesInRoute, int *pathLen);
@@ -277,31 +344,63 @@ int main(int argc, char **argv);
 
 // Implementation //
 
-ErrStatus loadFile(const char *filePath, FILE **fp, int *fSize)
+ErrStatus loadFile(const char *filePath, TextFile *file)
 {
+    file->data = NULL;
+    file->size = 0;
+    file->next = NULL;
     // we assume the file exists
-    *fp = fopen(filePath, "r");
-    if (*fp != NULL)
+    int fd = open(filePath, O_RDONLY);
+    if (fd == -1)
     {
-        int lineCounter = 0;
-        char line[TXT_FILE_LINE_LEN_LIMIT] = {'\0'};
-        while (fgets(line, sizeof(line), *fp))
+        return FAIL;
+    }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        size_t size = (size_t) fileStat.st_size;
+        void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
         {
-            if (strcmp(line, "\n") != 0) //if line not empty
-            {
-                lineCounter++;
-                memset(line, '\0', sizeof(line));
-            }
+            posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+            file->data = (char *) data;
+            file->size = size;
+            file->next = file->data;
         }
+    }
+    close(fd); // the mapping stays valid after the file is closed.
+    return file->data != NULL ? SUCCESS : FAIL;
+}
 
-        *fSize = lineCounter;
-        if (*fSize >= TXT_FILE_MIN_LINES)
-        {
-            fseek(*fp, 0, SEEK_SET);
-            return SUCCESS;
-        }
+void unloadFile(TextFile *file)
+{
+    if (file->data != NULL)
+    {
+        munmap(file->data, file->size);
+        file->data = NULL;
     }
-    return FAIL;
+}
+
+int nextLine(TextFile *file, const char **line, const char **lineEnd)
+{
+    const char *end = file->data + file->size;
+    if (file->next == end)
+    {
+        return 0;
+    }
+    *line = file->next;
+    const char *eol = (const char *) memchr(*line, '\n', end - *line);
+    if (eol == NULL) // last line, without '\n'.
+    {
+        *lineEnd = end;
+        file->next = end;
+    }
+    else
+    {
+        *lineEnd = eol;
+        file->next = eol + 1;
+    }
+    return 1;
 }
 
 ErrStatus parseNum(char *num, int *out)
@@ -318,16 +417,49 @@ ErrStatus parseNum(char *num, int *out)
     }
 }
 
-ErrStatus setVerticesNumber(FILE *fp, const int fileLength, int *numVertices)
+ErrStatus parseKey(const char *num, const char *numEnd, int *out)
+{
+    while (num < numEnd && isspace((unsigned char) *num)) // as strtol does.
+    {
+        num++;
+    }
+    int negative = 0;
+    if (num < numEnd && (*num == '+' || *num == '-'))
+    {
+        negative = *num == '-';
+        num++;
+    }
+    if (num == numEnd)
+    {
+        return FAIL;
+    }
+    int value = 0;
+    for (; num < numEnd; num++)
+    {
+        if (!isdigit((unsigned char) *num))
+        {
+            return FAIL;
+        }
+        int digit = *num - '0';
+        if (value > (INT_MAX - digit) / DECIMAL_BASE) // checked before the update can overflow.
+        {
+            return FAIL;
+        }
+        value = value * DECIMAL_BASE + digit;
+    }
+    *out = negative ? -value : value;
+    return SUCCESS;
+}
+
+ErrStatus setVerticesNumber(TextFile *file, int *numVertices)
 {
-    char line[TXT_FILE_LINE_LEN_LIMIT];
-    fgets(line, sizeof(line), fp);
-    if (parseNum(line, numVertices) == SUCCESS)
+    const char *line, *lineEnd;
+    if (nextLine(file, &line, &lineEnd) && parseKey(line, lineEnd, numVertices) == SUCCESS)
     {
-        if (*numVertices > 0 && (fileLength == VALID_LINE_NUM_IN_FILE(*numVertices)))
+        // n node lines take at least 2 chars each (the last one may have no '\n').
+        size_t nodesLinesSize = file->data + file->size - file->next;
+        if (*numVertices > 0 && (size_t) *numVertices <= (nodesLinesSize + 1) / MIN_NODE_LINE_LEN)
         {
-            // check if file length sufficient the lower bound for given n (cause we ignore empty
-            // lines in the end of the file.)
             return SUCCESS;
         }
     }
@@ -352,12 +484,11 @@ ErrStatus checkInputNodes(char first[], char second[], int *firstNodeKey, int *s
     return FAIL;
 }
 
-ErrStatus parseChildren(char *line, Node *const parent, Tree *tree,
+ErrStatus parseChildren(const char *line, const char *lineEnd, Node *const parent, Tree *tree,
                         int *childCounter, const int numVertices)
 {
     *childCounter = 0; // reset counter (fool safe).
-    if (line[0] == LEAF_SYMBOL || strcmp(line, LIN_LEAF_SYMBOL_EOL) == 0 ||
-        strcmp(line, WIN_LEAF_SYMBOL_EOL) == 0)
+    if (line[0] == LEAF_SYMBOL)
     {
         return SUCCESS;
     }
@@ -365,32 +496,43 @@ ErrStatus parseChildren(char *line, Node *const parent, Tree *tree,
     int maxKey = numVertices - 1; //starting from zero.
     int minKey = 0;
     int childKey;
-    // spilt by spaces, or EOF (just to get rid of garbage in the last child key
-    char *token = strtok(line, NODE_CHILDREN_TXT_DELIMITER);
-    if (token == NULL) // line doesn't contain number of leaf_symbol.
+    const char *token = line;
+    while (1)
     {
-        return FAIL;
-    }
-    while (token != NULL)
-    {
-        if (parseNum(token, &childKey) == SUCCESS)
+        // spilt by spaces, or '\r' (just to get rid of garbage in the last child key)
+        while (token < lineEnd && IS_CHILDREN_DELIMITER(*token))
+        {
+            token++;
+        }
+        if (token == lineEnd)
+        {
+            break;
+        }
+        const char *tokenEnd = token;
+        while (tokenEnd < lineEnd && !IS_CHILDREN_DELIMITER(*tokenEnd))
+        {
+            tokenEnd++;
+        }
+        // make sure the children count in tree <= edges in a tree of numVertices.
+        int childIndex = tree->nEdges + *childCounter;
+        if (parseKey(token, tokenEnd, &childKey) == SUCCESS &&
+            childIndex < VALID_N_EDGES_IN_TREE(numVertices))
         {
             // for every child check if within range and if tree isn't recursive.
             if ((minKey <= childKey && childKey <= maxKey) && childKey != parent->key)
             {
-                parent->children[*childCounter] = childKey; //add to the parent children arr.
+                tree->children[childIndex] = childKey; //add to the tree children arr.
                 (*childCounter)++;
                 // update the parent field for the children in tree nodes array
                 tree->nodes[childKey].parentNodeKey = parent->key;
 
-                token = strtok(NULL, NODE_CHILDREN_TXT_DELIMITER);
+                token = tokenEnd;
                 continue;
             }
         }
         return FAIL;
     }
-    // make sure childCount per Node in tree < numVertices specified in file.
-    if (*childCounter > numVertices)
+    if (*childCounter == 0) // line doesn't contain number of leaf_symbol.
     {
         return FAIL;
     }
@@ -416,59 +558,32 @@ ErrStatus setRoot(Tree *const tree)
     return SUCCESS;
 }
 
-ErrStatus addTreeVertices(FILE *fp, const int inputNumVertices, Tree *tree)
+ErrStatus addTreeVertices(TextFile *file, const int inputNumVertices, Tree *tree)
 {
-    fseek(fp, 0, SEEK_SET); // make sure to read file from the start.
-    char line[TXT_FILE_LINE_LEN_LIMIT] = "\0";
-    int lineCounter = 1;
+    const char *line, *lineEnd;
     tree->nVertices = 0;
     tree->nEdges = 0;
+    tree->childOffsets[0] = 0;
 
-    while (fgets(line, sizeof(line), fp) != NULL)
+    while (nextLine(file, &line, &lineEnd))
     {
-        if (lineCounter < FIRST_NODE_ROW_IN_FILE)
-        { // first row (nVertices) handled in another method.
-            lineCounter++;
-            continue;
+        if (line == lineEnd || tree->nVertices == inputNumVertices)
+        { // empty lines, and lines after the last node, are invalid.
+            return FAIL;
         }
         // build new Node in the tree.
         Node *v = &tree->nodes[tree->nVertices];
-        v->key = NODE_KEY(lineCounter);
+        v->key = tree->nVertices;
         tree->nVertices += 1;
 
-        lineCounter++;
         int childCount = 0;
 
-        v->children = (int *) malloc(inputNumVertices * sizeof(int));
-
-        if (v->children == NULL)
-        {
-            return MEM_ERR;
-        }
         // update the variables defined before.
-        if (parseChildren(line, v, tree, &childCount, inputNumVertices) ==
-            SUCCESS)
+        if (parseChildren(line, lineEnd, v, tree, &childCount, inputNumVertices) == SUCCESS)
         {
-            memset(line, '\0', sizeof(line)); //reset line values.
-
-            if (childCount == 0)
-            {
-                v->isLeaf = 1;
-                v->nChildren = 0;
-                free(v->children);
-                v->children = NULL;
-            }
-            else
-            {
-                v->children = (int *) realloc(v->children, childCount * sizeof(int));
-                if (v->children == NULL)
-                {
-                    return MEM_ERR;
-                }
-                v->nChildren = childCount;
-                v->isLeaf = 0;
-                tree->nEdges += childCount;
-            }
+            v->isLeaf = childCount == 0;
+            tree->nEdges += childCount;
+            tree->childOffsets[tree->nVertices] = tree->nEdges;
         }
         else //if parsing node children returned failure
         {
@@ -479,12 +594,11 @@ ErrStatus addTreeVertices(FILE *fp, const int inputNumVertices, Tree *tree)
 }
 
 
-ErrStatus initTools(const char *filePath, FILE **fp, char *firstNode, char *secondNode,
+ErrStatus initTools(const char *filePath, TextFile *file, char *firstNode, char *secondNode,
                     int *inputNumVertices, int *uKey, int *vKey)
 {
-    int fSize = 0;
-    if (loadFile(filePath, fp, &fSize) == SUCCESS &&
-        setVerticesNumber(*fp, fSize, inputNumVertices) == SUCCESS &&
+    if (loadFile(filePath, file) == SUCCESS &&
+        setVerticesNumber(file, inputNumVertices) == SUCCESS &&
         checkInputNodes(firstNode, secondNode, uKey, vKey, *inputNumVertices) == SUCCESS)
     {
         return SUCCESS;
@@ -499,10 +613,10 @@ ErrStatus initTools(const char *filePath, FILE **fp, char *firstNode, char *seco
 ErrStatus buildTree(const char *filePath, char *firstNode, char *secondNode, Tree **outTree,
                     int *firstNodeKey, int *secondNodeKey)
 {
-    FILE *fp = NULL;
+    TextFile file = {NULL, 0, NULL};
     int inputNumVertices;
     int uKey, vKey;
-    ErrStatus utilsStatus = initTools(filePath, &fp, firstNode, secondNode, &inputNumVertices,
+    ErrStatus utilsStatus = initTools(filePath, &file, firstNode, secondNode, &inputNumVertices,
                                       &uKey, &vKey);
     if (utilsStatus == SUCCESS)
     {
@@ -512,21 +626,23 @@ ErrStatus buildTree(const char *filePath, char *firstNode, char *secondNode, Tre
 
         if (tree == NULL)
         {
-            fclose(fp);
+            unloadFile(&file);
             return MEM_ERR;
         }
         tree->root = NULL;
+        tree->nVertices = 0;
         tree->nodes = (Node *) malloc(inputNumVertices * sizeof(Node));
-        memset(tree->nodes, UNINITIALIZED_TREE_VAL, inputNumVertices * sizeof(Node));
+        tree->childOffsets = (int *) malloc((inputNumVertices + 1) * sizeof(int));
+        tree->children = (int *) malloc(inputNumVertices * sizeof(int)); // n - 1 used.
 
-        if (tree->nodes == NULL)
+        if (tree->nodes == NULL || tree->childOffsets == NULL || tree->children == NULL)
         {
-            fclose(fp);
+            unloadFile(&file);
             return MEM_ERR;
         }
+        memset(tree->nodes, UNINITIALIZED_TREE_VAL, inputNumVertices * sizeof(Node));
 
-        ErrStatus verticesAdded = addTreeVertices(fp, inputNumVertices, tree);
-        if (verticesAdded == SUCCESS)
+        if (addTreeVertices(&file, inputNumVertices, tree) == SUCCESS)
         {
             if (tree->nVertices == inputNumVertices &&
                 tree->nEdges == VALID_N_EDGES_IN_TREE(tree->nVertices) &&
@@ -534,20 +650,12 @@ ErrStatus buildTree(const char *filePath, char *firstNode, char *secondNode, Tre
             {
                 *firstNodeKey = uKey;
                 *secondNodeKey = vKey;
-                fclose(fp);
+                unloadFile(&file);
                 return SUCCESS;
             }
         }
-        if (verticesAdded == MEM_ERR)
-        {
-            fclose(fp);
-            return MEM_ERR;
-        }
-    }
-    if (fp != NULL)
-    {
-        fclose(fp);
     }
+    unloadFile(&file);
     return FAIL;
 }
 
@@ -555,142 +663,168 @@ void freeTree(Tree *tree)
 {
     if (tree != NULL)
     {
+        free(tree->children);
+        free(tree->childOffsets);
+        free(tree->nodes);
+        free(tree);
+    }
+}
 
-        for (int i = 0; i < tree->nVertices; i++)
+int findAncestorAtDepth(const Tree *tree, int nodeKey, const int depth)
+{
+    while (tree->nodes[nodeKey].depth > depth)
+    {
+        const Node *v = &tree->nodes[nodeKey];
+        if (tree->nodes[v->jumpKey].depth >= depth)
         {
-            if (tree->nodes != NULL && tree->nodes[i].children != NULL)
-            {
-                free(tree->nodes[i].children);
-            }
+            nodeKey = v->jumpKey;
         }
-        if (tree->nodes != NULL)
+        else
         {
-            free(tree->nodes);
+            nodeKey = v->parentNodeKey;
         }
-        free(tree);
     }
+    return nodeKey;
 }
 
-void BFS(const Tree *tree, const int startNodeKey)
+int findLowestCommonAncestor(const Tree *tree, int uKey, int vKey)
 {
-    for (int i = 0; i < tree->nVertices; i++)
+    if (tree->nodes[uKey].depth > tree->nodes[vKey].depth)
+    {
+        uKey = findAncestorAtDepth(tree, uKey, tree->nodes[vKey].depth);
+    }
+    else
     {
-        tree->nodes[i].dist = UNINITIALIZED_TREE_VAL;
-        tree->nodes[i].previousKey = UNINITIALIZED_TREE_VAL;
+        vKey = findAncestorAtDepth(tree, vKey, tree->nodes[uKey].depth);
     }
-    Node *start = &tree->nodes[startNodeKey];
-    start->dist = 0;
-    Queue *Q = allocQueue();
-    enqueue(Q, start->key);
-    while (queueIsEmpty(Q) == 0) //not empty
+    while (uKey != vKey)
     {
-        int u = (int) dequeue(Q);
-        for (int j = 0; j < tree->nodes[u].nChildren; j++)
+        const Node *u = &tree->nodes[uKey];
+        const Node *v = &tree->nodes[vKey];
+        if (u->jumpKey != v->jumpKey)
         {
-            int childKey = tree->nodes[u].children[j];
-            Node *child = &tree->nodes[childKey];
-            if (child->dist == UNINITIALIZED_TREE_VAL)
-            {
-                enqueue(Q, childKey);
-                child->previousKey = u;
-                child->dist = tree->nodes[u].dist + 1;
-            }
+            uKey = u->jumpKey;
+            vKey = v->jumpKey;
         }
-        int pKey = tree->nodes[u].parentNodeKey;
-        if (pKey != UNINITIALIZED_TREE_VAL) // if have parent
+        else
         {
-            Node *parent = &tree->nodes[pKey];
-            if (parent != NULL && parent->dist == UNINITIALIZED_TREE_VAL)
-            {
-                enqueue(Q, parent->key);
-                parent->previousKey = u;
-                parent->dist = tree->nodes[u].dist + 1;
-            }
+            uKey = u->parentNodeKey;
+            vKey = v->parentNodeKey;
         }
     }
-    freeQueue(&Q);
+    return uKey;
 }
 
 
-void calcMinimalAndMaximalHeight(const Tree *tree, int *maxHeight, int *minHeight, int
-                                 *deepestLeafKey)
+ErrStatus calcTreeMetrics(const Tree *tree, TreeMetrics *const metrics)
 {
-    //reset
-    *maxHeight = 0;
-    *minHeight = VALID_N_EDGES_IN_TREE(tree->nVertices); //longest possible route length.
+    int *order = (int *) malloc(tree->nVertices * sizeof(int));
+    int *height = (int *) malloc(tree->nVertices * sizeof(int)); // of the subtree of every node.
+    if (order == NULL || height == NULL)
+    {
+        free(order);
+        free(height);
+        return MEM_ERR;
+    }
 
-    BFS(tree, tree->root->key);
-    for (int i = 0; i < tree->nVertices; i++)
+    //reset
+    metrics->maxHeight = 0;
+    metrics->minHeight = VALID_N_EDGES_IN_TREE(tree->nVertices); //longest possible route length.
+    metrics->diameter = 0;
+
+    // forward pass - the order array is used as the BFS queue.
+    int nOrdered = 0;
+    order[nOrdered++] = tree->root->key;
+    tree->root->depth = 0;
+    tree->root->jumpKey = tree->root->key;
+    for (int i = 0; i < nOrdered; i++)
     {
-        Node *v = &tree->nodes[i];
-        if (v->isLeaf == 1)
+        const Node *parent = &tree->nodes[order[i]];
+        if (parent->isLeaf == 1)
         {
-            if (v->dist > *maxHeight)
+            if (parent->depth > metrics->maxHeight)
             {
-                *maxHeight = v->dist;
-                *deepestLeafKey = v->key;
+                metrics->maxHeight = parent->depth;
             }
-            if (v->dist < *minHeight)
+            if (parent->depth < metrics->minHeight)
             {
-                *minHeight = v->dist;
+                metrics->minHeight = parent->depth;
             }
         }
+        const Node *jump = &tree->nodes[parent->jumpKey];
+        const Node *jumpOfJump = &tree->nodes[jump->jumpKey];
+        // the children jump twice as far as their parent jumps, if it jumps as far as its jump.
+        int childJumpKey = parent->key;
+        if (parent->depth - jump->depth == jump->depth - jumpOfJump->depth)
+        {
+            childJumpKey = jumpOfJump->key;
+        }
+        for (int j = tree->childOffsets[parent->key]; j < tree->childOffsets[parent->key + 1]; j++)
+        {
+            Node *child = &tree->nodes[tree->children[j]];
+            child->depth = parent->depth + 1;
+            child->jumpKey = childJumpKey;
+            order[nOrdered++] = child->key;
+        }
     }
-}
-
 
-void calcTreeDiameter(const Tree *tree, const int deepestLeafKey, int *const diameter)
-{
-    if (tree->nVertices == 1)
-    {
-        *diameter = 0;
-    }
-    else if (tree->nVertices == 2)
+    // backward pass - the children heights are ready before their parent is visited.
+    for (int i = nOrdered - 1; i >= 0; i--)
     {
-        *diameter = 1;
-    }
-    else
-    {
-        *diameter = 0; //reset
-        BFS(tree, deepestLeafKey);
-
-        // flag the root as a leaf (in a graph perspective)
-        tree->root->isLeaf = 1;
-
-        for (int i = 0; i < tree->nVertices; i++)
+        int u = order[i];
+        int highest = 0, secondHighest = 0; // routes down from u through two different children.
+        for (int j = tree->childOffsets[u]; j < tree->childOffsets[u + 1]; j++)
         {
-            Node *v = &tree->nodes[i];
-            if (v->isLeaf == 1)
+            int route = height[tree->children[j]] + 1;
+            if (route > highest)
+            {
+                secondHighest = highest;
+                highest = route;
+            }
+            else if (route > secondHighest)
             {
-                if (v->dist > *diameter)
-                {
-                    *diameter = v->dist;
-                }
+                secondHighest = route;
             }
         }
+        height[u] = highest;
+        if (highest + secondHighest > metrics->diameter)
+        {
+            metrics->diameter = highest + secondHighest;
+        }
     }
+
+    free(order);
+    free(height);
+    return nOrdered == tree->nVertices ? SUCCESS : FAIL;
 }
 
 
 void findDistance(const Tree *tree, const int startNodeKey, const int endNodeKey,
                   int **nodesInRoute, int *pathLen)
 {
-    BFS(tree, endNodeKey);
-    int pathLength = tree->nodes[startNodeKey].dist;
+    int ancestorKey = findLowestCommonAncestor(tree, startNodeKey, endNodeKey);
+    int ancestorDepth = tree->nodes[ancestorKey].depth;
+    int pathLength = tree->nodes[startNodeKey].depth + tree->nodes[endNodeKey].depth -
+                     2 * ancestorDepth;
     *pathLen = ++pathLength; // add the last node in path.
 
-    if (pathLength != 0)
+    *nodesInRoute = (int *) malloc(sizeof(int) * pathLength);
+    if (*nodesInRoute == NULL)
     {
-        *nodesInRoute = (int *) malloc(sizeof(int) * pathLength);
-        memset(*nodesInRoute, 0, sizeof(int) * pathLength);
-        int nextKeyInPath = startNodeKey;
-        for (int i = 0; i < pathLength; i++)
-        {
-            (*nodesInRoute)[i] = nextKeyInPath;
-            nextKeyInPath = tree->nodes[nextKeyInPath].previousKey;
-        }
+        *pathLen = 0;
+        return;
+    }
+    int i = 0;
+    for (int key = startNodeKey; key != ancestorKey; key = tree->nodes[key].parentNodeKey)
+    {
+        (*nodesInRoute)[i++] = key;
+    }
+    (*nodesInRoute)[i] = ancestorKey;
+    i = pathLength - 1;
+    for (int key = endNodeKey; key != ancestorKey; key = tree->nodes[key].parentNodeKey)
+    {
+        (*nodesInRoute)[i--] = key;
     }
-
 }
 
 void printRoute(int *const nodesInRoute, const int pathLength, const int pathStartNodeKey, const
@@ -711,26 +845,31 @@ void printRoute(int *const nodesInRoute, const int pathLength, const int pathSta
     }
 }
 
-void printTreeDetails(const Tree *tree, const int pathStartNodeKey, const int pathEndNodeKey)
+ErrStatus printTreeDetails(const Tree *tree, const int pathStartNodeKey, const int pathEndNodeKey)
 {
-    int maxHeight, minHeight;
-    int deepestLeafKey;
-    int diameter;
-    calcMinimalAndMaximalHeight(tree, &maxHeight, &minHeight, &deepestLeafKey);
-    calcTreeDiameter(tree, deepestLeafKey, &diameter);
+    TreeMetrics metrics;
+    ErrStatus metricsStatus = calcTreeMetrics(tree, &metrics);
+    if (metricsStatus != SUCCESS)
+    {
+        return metricsStatus;
+    }
 
     int *nodesInRoute = NULL;
     int pathLength = 0;
-
     findDistance(tree, pathStartNodeKey, pathEndNodeKey, &nodesInRoute, &pathLength);
+    if (pathLength == 0) // a route has at least one node.
+    {
+        return MEM_ERR;
+    }
 
     printf("Root Vertex: %d\n", tree->root->key);
     printf("Vertices Count: %d\n", tree->nVertices);
     printf("Edges Count: %d\n", tree->nEdges);
-    printf("Length of Minimal Branch: %d\n", minHeight);
-    printf("Length of Maximal Branch: %d\n", maxHeight);
-    printf("Diameter Length: %d\n", diameter);
+    printf("Length of Minimal Branch: %d\n", metrics.minHeight);
+    printf("Length of Maximal Branch: %d\n", metrics.maxHeight);
+    printf("Diameter Length: %d\n", metrics.diameter);
     printRoute(nodesInRoute, pathLength, pathStartNodeKey, pathEndNodeKey);
+    return SUCCESS;
 }
 
 
@@ -744,7 +883,10 @@ int analyze(char *const *argv)
                                   &pathEndNodeKey);
     if (errType == SUCCESS)
     {
-        printTreeDetails(tree, pathStartNodeKey, pathEndNodeKey);
+        errType = printTreeDetails(tree, pathStartNodeKey, pathEndNodeKey);
+    }
+    if (errType == SUCCESS)
+    {
         freeTree(tree);
         return EXIT_SUCCESS;
     }
@@ -0,0 +1,217 @@
+#define _POSIX_C_SOURCE 200809L // for clock_gettime with -std=c99
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <time.h>
+#include "queue.h"
+
+#define NUM_ITEMS 4000000
+#define STEADY_SIZE 1000 // items in the queue while it is enqueued and dequeued in turns.
+#define NUM_RUNS 3 // the fastest run is reported.
+
+/**
+ * a node of ListQueue.
+ */
+typedef struct ListNode
+{
+    unsigned int value;
+    struct ListNode* next;
+} ListNode;
+
+/**
+ * the baseline: a queue kept in a linked list, a node is allocated for every enqueue and freed by
+ * its dequeue.
+ */
+typedef struct
+{
+    ListNode* head;
+    ListNode* tail;
+} ListQueue;
+
+/**
+ * a tree in a compressed sparse row layout, as TreeAnalyzer keeps it: the children of node v are
+ * children[childOffsets[v]] ... children[childOffsets[v + 1] - 1].
+ */
+typedef struct
+{
+    int* childOffsets;
+    int* children;
+    int nVertices;
+} BenchTree;
+
+/**
+ * @return the time in seconds, from an arbitrary starting point.
+ */
+double benchNow()
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double) t.tv_sec + (double) t.tv_nsec * 1e-9;
+}
+
+/**
+ * Enqueues the given value in a ListQueue.
+ */
+void listEnqueue(ListQueue* queue, unsigned int value)
+{
+    ListNode* node = malloc(sizeof(ListNode));
+    assert(node != NULL);
+    node->value = value;
+    node->next = NULL;
+    if (queue->tail == NULL)
+    {
+        queue->head = node;
+    }
+    else
+    {
+        queue->tail->next = node;
+    }
+    queue->tail = node;
+}
+
+/**
+ * Dequeues an item from a ListQueue, it must not be empty.
+ * @return The dequeued item value.
+ */
+unsigned int listDequeue(ListQueue* queue)
+{
+    ListNode* node = queue->head;
+    unsigned int value = node->value;
+    queue->head = node->next;
+    if (queue->head == NULL)
+    {
+        queue->tail = NULL;
+    }
+    free(node);
+    return value;
+}
+
+/**
+ * Builds a random tree: the parent of every node is a random node before it, so the tree is
+ * shallow and wide.
+ * @param tree Will hold the tree.
+ * @param nVertices The number of nodes.
+ */
+void newBenchTree(BenchTree* tree, int nVertices)
+{
+    int* parents = malloc(nVertices * sizeof(int));
+    int* next = malloc(nVertices * sizeof(int)); // where the next child of every node goes.
+    tree->childOffsets = calloc(nVertices + 1, sizeof(int));
+    tree->children = malloc(nVertices * sizeof(int));
+    assert(parents != NULL && next != NULL && tree->childOffsets != NULL && tree->children != NULL);
+    tree->nVertices = nVertices;
+    for (int v = 1; v < nVertices; v++)
+    {
+        parents[v] = rand() % v;
+        tree->childOffsets[parents[v] + 1]++;
+    }
+    for (int v = 0; v < nVertices; v++)
+    {
+        tree->childOffsets[v + 1] += tree->childOffsets[v];
+        next[v] = tree->childOffsets[v];
+    }
+    for (int v = 1; v < nVertices; v++)
+    {
+        tree->children[next[parents[v]]++] = v;
+    }
+    free(parents);
+    free(next);
+}
+
+/**
+ * Times one of the queue workloads.
+ * @param workload 0 to enqueue all the items and then dequeue them, 1 to enqueue and dequeue in
+ * turns, 2 for a BFS of the tree.
+ * @param list 0 for the ring buffer Queue, other for ListQueue.
+ * @param checksum Will hold the sum of the dequeued values.
+ * @return The fastest time of a run, in seconds.
+ */
+double timeQueue(int workload, int list, const BenchTree* tree, unsigned long long* checksum)
+{
+    double best = 0;
+    for (int run = 0; run < NUM_RUNS; run++)
+    {
+        Queue* ring = allocQueue();
+        ListQueue linked = {NULL, NULL};
+        unsigned long long sum = 0;
+        double start = benchNow();
+        if (workload == 0)
+        {
+            for (unsigned int i = 0; i < NUM_ITEMS; i++)
+            {
+                list ? listEnqueue(&linked, i) : enqueue(ring, i);
+            }
+            for (unsigned int i = 0; i < NUM_ITEMS; i++)
+            {
+                sum += list ? listDequeue(&linked) : dequeue(ring);
+            }
+        }
+        else if (workload == 1)
+        {
+            for (unsigned int i = 0; i < NUM_ITEMS; i++)
+            {
+                list ? listEnqueue(&linked, i) : enqueue(ring, i);
+                if (i >= STEADY_SIZE)
+                {
+                    sum += list ? listDequeue(&linked) : dequeue(ring);
+                }
+            }
+            for (unsigned int i = 0; i < STEADY_SIZE; i++)
+            {
+                sum += list ? listDequeue(&linked) : dequeue(ring);
+            }
+        }
+        else
+        {
+            list ? listEnqueue(&linked, 0) : enqueue(ring, 0);
+            for (int visited = 0; visited < tree->nVertices; visited++)
+            {
+                unsigned int u = list ? listDequeue(&linked) : dequeue(ring);
+                sum += u * (unsigned long long) visited; // the BFS order, not only the nodes.
+                for (int j = tree->childOffsets[u]; j < tree->childOffsets[u + 1]; j++)
+                {
+                    unsigned int child = tree->children[j];
+                    list ? listEnqueue(&linked, child) : enqueue(ring, child);
+                }
+            }
+        }
+        double elapsed = benchNow() - start;
+        freeQueue(&ring);
+        *checksum = sum;
+        if (run == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+/**
+ * Prints the throughput of the ring buffer Queue against a linked list queue, in millions of
+ * items per second: enqueueing all the items and then dequeueing them, enqueueing and dequeueing
+ * in turns, and a BFS of a random tree.
+ * @return 0 if both queues dequeued the same values, 1 otherwise.
+ */
+int main()
+{
+    const char* workloads[] = {"fill+drain", "steady", "bfs"};
+    BenchTree tree;
+    srand(48);
+    newBenchTree(&tree, NUM_ITEMS);
+
+    int mismatches = 0;
+    printf("%d items, Mitems/s\n%-12s %10s %10s %8s\n", NUM_ITEMS, "workload", "ring", "list",
+           "speedup");
+    for (int workload = 0; workload < 3; workload++)
+    {
+        unsigned long long ringSum = 0, listSum = 0;
+        double ringTime = timeQueue(workload, 0, &tree, &ringSum);
+        double listTime = timeQueue(workload, 1, &tree, &listSum);
+        mismatches += (ringSum != listSum);
+        printf("%-12s %10.1f %10.1f %7.1fx\n", workloads[workload], NUM_ITEMS / ringTime * 1e-6,
+               NUM_ITEMS / listTime * 1e-6, listTime / ringTime);
+    }
+    free(tree.childOffsets);
+    free(tree.children);
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
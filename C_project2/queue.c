@@ -1,9 +1,44 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 #include <limits.h>
 #include "queue.h"
 
+#define QUEUE_INITIAL_CAPACITY 16 // must be a power of two.
+
+/**
+ * Moves the items of the queue to a new ring buffer, starting at its beginning.
+ * @param queue The queue.
+ * @param capacity The minimal capacity of the new buffer, rounded up to a power of two.
+ */
+void resizeQueue(Queue* queue, unsigned int capacity)
+{
+    unsigned int newCapacity = queue->capacity;
+    while (newCapacity < capacity)
+    {
+        assert(newCapacity <= UINT_MAX / 2);
+        newCapacity *= 2;
+    }
+
+    unsigned int* items = malloc(newCapacity * sizeof(unsigned int));
+    assert(items != NULL);
+
+    /* The items may wrap around the end of the old buffer */
+    unsigned int firstPart = queue->capacity - queue->head;
+    if (firstPart > queue->size)
+    {
+        firstPart = queue->size;
+    }
+    memcpy(items, queue->items + queue->head, firstPart * sizeof(unsigned int));
+    memcpy(items + firstPart, queue->items, (queue->size - firstPart) * sizeof(unsigned int));
+
+    free(queue->items);
+    queue->items = items;
+    queue->capacity = newCapacity;
+    queue->head = 0;
+}
+
 /**
  * Allocates a new, empty, queue.
  * @return The queue.
@@ -13,8 +48,11 @@ Queue* allocQueue()
     Queue* q = malloc(sizeof(Queue));
     assert(q != NULL);
 
-    q->head = NULL;
-    q->tail = NULL;
+    q->items = malloc(QUEUE_INITIAL_CAPACITY * sizeof(unsigned int));
+    assert(q->items != NULL);
+    q->capacity = QUEUE_INITIAL_CAPACITY;
+    q->head = 0;
+    q->size = 0;
 
     return q;
 }
@@ -31,19 +69,9 @@ void freeQueue(Queue** queue)
         return;
     }
 
-    /* If the queue is not empty, free all of it's items.
-     * Remember: free'ing the Queue object alone won't free its
-     * nodes - which means they'll cause a memory leak. */
-    QueueNode* ptr = (*queue)->head;
-    QueueNode* next = NULL;
-    while (ptr != NULL)
-    {
-        next = ptr->next;
-        free(ptr);
-        ptr = next;
-    }
-    (*queue)->head = NULL;
-    (*queue)->tail = NULL;
+    /* The items are kept in a single buffer, free it with the queue */
+    free((*queue)->items);
+    (*queue)->items = NULL;
 
     /* Now we can free the queue itself and mark it as NULL so we can
      * know that it was de-allocated. */
@@ -58,7 +86,7 @@ void freeQueue(Queue** queue)
  */
 int queueIsEmpty(Queue* queue)
 {
-    return queue->head == NULL;
+    return queue->size == 0;
 }
 
 /**
@@ -68,28 +96,33 @@ int queueIsEmpty(Queue* queue)
  */
 void enqueue(Queue* queue, unsigned int value)
 {
-    /* Allocates a new queue item */
-    QueueNode* item = malloc(sizeof(QueueNode));
-    assert(item != NULL);
-
-    item->data = value;
-    item->next = NULL;
-
-    /* Connect */
-    if (queue->head == NULL)
+    /* Doubles the buffer when it's full, so n enqueues take O(log n) allocations */
+    if (queue->size == queue->capacity)
     {
-        queue->head = queue->tail = item;
+        resizeQueue(queue, queue->capacity + 1);
     }
-    else
+
+    queue->items[(queue->head + queue->size) & (queue->capacity - 1)] = value;
+    queue->size++;
+}
+
+/**
+ * Makes sure the queue can hold capacity items without growing.
+ * @param queue The queue.
+ * @param capacity The number of items to make room for.
+ */
+void queueReserve(Queue* queue, unsigned int capacity)
+{
+    if (capacity > queue->capacity)
     {
-        queue->tail = queue->tail->next = item;
+        resizeQueue(queue, capacity);
     }
 }
 
 /**
  * Dequeues an item from the given queue.
  * @param queue The queue.
- * @return The dequeued item value, or INT_MIN if there's no such item.
+ * @return The dequeued item value, or UINT_MAX if there's no such item.
  */
 unsigned int dequeue(Queue* queue)
 {
@@ -98,18 +131,10 @@ unsigned int dequeue(Queue* queue)
         return UINT_MAX;
     }
 
-    /* Save the removed value */
-    unsigned int value = queue->head->data;
-    QueueNode* next = queue->head->next;
-
-    /* Remove from the queue head */
-    free(queue->head);
-    queue->head = next;
-
-    if (queue->head == NULL)
-    {
-        queue->tail = NULL;
-    }
+    /* Save the removed value, and move the head forward */
+    unsigned int value = queue->items[queue->head];
+    queue->head = (queue->head + 1) & (queue->capacity - 1);
+    queue->size--;
 
     return value;
 }
@@ -121,7 +146,7 @@ unsigned int dequeue(Queue* queue)
  */
 unsigned int peekQueue(Queue* queue)
 {
-    return queue->head->data;
+    return queue->items[queue->head];
 }
 
 
@@ -131,19 +156,16 @@ unsigned int peekQueue(Queue* queue)
  */
 void printQueue(Queue* queue)
 {
-    if (queue->head == NULL)
+    if (queue->size == 0)
     {
         printf("[]");
         return;
     }
 
-    QueueNode* ptr = queue->head;
-
     printf("[head -> ");
-    while (ptr != NULL)
+    for (unsigned int i = 0; i < queue->size; i++)
     {
-        printf("[%d]", ptr->data);
-        ptr = ptr->next;
+        printf("[%d]", queue->items[(queue->head + i) & (queue->capacity - 1)]);
     }
 
     printf(" <- tail]\n");
@@ -2,21 +2,16 @@
 #define QUEUE_H
 
 /**
- * @brief Describes a node in the queue.
- */
-typedef struct queue_node_t
-{
-    unsigned int data;
-    struct queue_node_t* next;
-} QueueNode;
-
-/**
- * @brief Describes a simple queue.
+ * @brief Describes a simple queue, kept in a growable ring buffer.
+ * the items are items[head], items[(head + 1) & (capacity - 1)], ... (size items), so the
+ * capacity is always a power of two.
  */
 typedef struct
 {
-    QueueNode* head;
-    QueueNode* tail;
+    unsigned int* items;
+    unsigned int capacity;
+    unsigned int head;
+    unsigned int size;
 } Queue;
 
 /**
@@ -45,6 +40,14 @@ int queueIsEmpty(Queue* queue);
  */
 void enqueue(Queue* queue, unsigned int value);
 
+/**
+ * Makes sure the given queue can hold at least capacity items without growing, so a known
+ * number of enqueues won't reallocate the queue.
+ * @param queue The queue.
+ * @param capacity The number of items to make room for.
+ */
+void queueReserve(Queue* queue, unsigned int capacity);
+
 /**
  * Dequeue an item from the given queue.
  * @param queue The queue.
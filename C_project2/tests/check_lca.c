@@ -0,0 +1,98 @@
+// checks findLowestCommonAncestor of TreeAnalyzer against a walk up the parents, on every pair of
+// nodes of small trees and on random pairs of larger ones.
+#define main treeAnalyzerMain
+#include "../TreeAnalyzer.c"
+#undef main
+
+#define MAX_ALL_PAIRS_VERTICES 300 // larger trees are checked on random pairs.
+#define NUM_RANDOM_PAIRS 200000
+
+/**
+ * finds the lowest common ancestor of two nodes by walking up their parents, in O(depth).
+ * @param tree pointer to a tree whose depths are set.
+ * @param uKey key of a node in the tree.
+ * @param vKey key of a node in the tree.
+ * @return the key of the lowest common ancestor.
+ */
+int walkToCommonAncestor(const Tree *tree, int uKey, int vKey)
+{
+    while (tree->nodes[uKey].depth > tree->nodes[vKey].depth)
+    {
+        uKey = tree->nodes[uKey].parentNodeKey;
+    }
+    while (tree->nodes[vKey].depth > tree->nodes[uKey].depth)
+    {
+        vKey = tree->nodes[vKey].parentNodeKey;
+    }
+    while (uKey != vKey)
+    {
+        uKey = tree->nodes[uKey].parentNodeKey;
+        vKey = tree->nodes[vKey].parentNodeKey;
+    }
+    return uKey;
+}
+
+/**
+ * checks the lowest common ancestors of a tree file.
+ * @param filePath path of a valid tree file.
+ * @return the number of pairs whose ancestors differ, -1 if the tree can't be built.
+ */
+int checkTreeFile(const char *filePath)
+{
+    Tree *tree = NULL;
+    int firstKey, secondKey;
+    char first[] = "0", second[] = "0";
+    TreeMetrics metrics;
+    if (buildTree(filePath, first, second, &tree, &firstKey, &secondKey) != SUCCESS ||
+        calcTreeMetrics(tree, &metrics) != SUCCESS)
+    {
+        freeTree(tree);
+        return -1;
+    }
+    int n = tree->nVertices;
+    int mismatches = 0;
+    if (n <= MAX_ALL_PAIRS_VERTICES)
+    {
+        for (int u = 0; u < n; u++)
+        {
+            for (int v = 0; v < n; v++)
+            {
+                mismatches += (findLowestCommonAncestor(tree, u, v) !=
+                               walkToCommonAncestor(tree, u, v));
+            }
+        }
+    }
+    else
+    {
+        for (int i = 0; i < NUM_RANDOM_PAIRS; i++)
+        {
+            int u = rand() % n;
+            int v = rand() % n;
+            mismatches += (findLowestCommonAncestor(tree, u, v) !=
+                           walkToCommonAncestor(tree, u, v));
+        }
+    }
+    freeTree(tree);
+    return mismatches;
+}
+
+/**
+ * checks the lowest common ancestors of every tree file given.
+ * @return 0 if all the trees were built and all their ancestors match, 1 otherwise.
+ */
+int main(int argc, char **argv)
+{
+    int failures = 0;
+    srand(46);
+    for (int i = 1; i < argc; i++)
+    {
+        int mismatches = checkTreeFile(argv[i]);
+        if (mismatches != 0)
+        {
+            printf("FAILED: %s (%d)\n", argv[i], mismatches);
+            failures++;
+        }
+    }
+    printf("%d of %d trees passed\n", argc - 1 - failures, argc - 1);
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
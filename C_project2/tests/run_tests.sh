@@ -0,0 +1,40 @@
+#!/bin/sh
+# runs TreeAnalyzer on every input of tests/inputs with a few pairs of vertices: the two ends of
+# the key range, two middle keys, a key that isn't a number and a key out of range. the output,
+# the errors and the exit code of every run are compared with tests/expected/<input>.out.
+# usage: run_tests.sh <TreeAnalyzer binary> [--update]
+# with --update the expected outputs are rewritten instead.
+
+if [ $# -lt 1 ]; then
+    echo "usage: run_tests.sh <TreeAnalyzer binary> [--update]" >&2
+    exit 2
+fi
+analyzer=$1
+dir=$(cd "$(dirname "$0")" && pwd)
+actual=$(mktemp) || exit 2
+trap 'rm -f "$actual"' EXIT
+failures=0
+total=0
+
+for input in "$dir"/inputs/*.txt; do
+    name=$(basename "$input" .txt)
+    n=$(head -n 1 "$input" | tr -dc '0-9')
+    [ -z "$n" ] && n=1
+    for args in "0 0" "0 $((n - 1))" "$((n / 2)) $((n / 3))" "$((n - 1)) 1" "x 0" "0 $n"; do
+        echo "== $args"
+        # shellcheck disable=SC2086 # the two vertices are split on purpose.
+        "$analyzer" "$input" $args 2>&1
+        echo "exit $?"
+    done > "$actual"
+    total=$((total + 1))
+    if [ "$2" = "--update" ]; then
+        cp "$actual" "$dir/expected/$name.out"
+    elif ! diff -u "$dir/expected/$name.out" "$actual" > /dev/null 2>&1; then
+        echo "FAILED: $name"
+        diff -u "$dir/expected/$name.out" "$actual" | head -n 20
+        failures=$((failures + 1))
+    fi
+done
+
+echo "$((total - failures)) of $total inputs passed"
+[ "$failures" -eq 0 ]